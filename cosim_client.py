@@ -0,0 +1,270 @@
+"""
+End-to-end co-simulation: Python client <-> Verilated prf_evaluate_message.
+
+This script:
+1. Loads the LWR-PRF client in a run directory (secret_key.json, and
+   secret_key.mem, the initial RTL key store, are written there)
+2. Optionally builds the Verilator co-simulation server (cosim_server.cpp)
+3. Creates a shared-memory ring and starts the server on it
+4. Streams a message through the simulated hardware in batches
+5. Reports effective throughput and cross-checks the first --check symbols
+   of the ciphertext against LWR_PRF_Client.encrypt_message
+
+The ring layout is documented in cosim_server.cpp; the offsets below must
+match it. Batches are handed over by bumping the head counter after the
+entry is written, results are read back once the server's tail counter
+has passed the entry. Nonces are limited to MAX_NONCE bytes, the size of
+the entry's nonce field.
+
+Usage:
+  python3 cosim_client.py --build                  # build server, 64 KiB message
+  python3 cosim_client.py --bytes 1048576 --batch 4096 --check 0
+  python3 cosim_client.py --run-dir cosim_run       # keep the key files
+"""
+
+import argparse
+import importlib.util
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+from multiprocessing import shared_memory
+
+import numpy as np
+
+# Import the Python implementation
+spec = importlib.util.spec_from_file_location(
+    "lwr_prf_client",
+    os.path.join(os.path.dirname(os.path.abspath(__file__)), "lwr-prf-client.py"))
+lwr_prf_client = importlib.util.module_from_spec(spec)
+spec.loader.exec_module(lwr_prf_client)
+
+LWR_PRF_Client = lwr_prf_client.LWR_PRF_Client
+
+# Ring layout (see cosim_server.cpp)
+RING_MAGIC = 0x5052574C
+RING_VERSION = 1
+HEADER_SIZE = 64
+ENTRY_DATA = 128
+MAX_NONCE = 64
+OFF_HEAD = 16
+OFF_TAIL = 24
+OFF_SHUTDOWN = 32
+
+NONCE_TOO_LONG = f"nonce longer than {MAX_NONCE} bytes"  # as in cosim_server.cpp
+STATUS_NAMES = {0: "ok", 1: NONCE_TOO_LONG, 2: "timeout"}
+
+TOP = "prf_evaluate_message"
+RTL_SOURCES = [
+    "keccak_round.v",
+    "keccak_f1600.v",
+    "shake256.v",
+    "hash_to_vector.v",
+    "secret_key.v",
+    "dot_product.v",
+    "dot_product_bitplane.v",
+    "prf_rounding.v",
+    "perf_counters.v",
+    "prf_evaluate.v",
+    "encrypt.v",
+    "prf_evaluate_message.v",
+]
+
+
+def entry_size(capacity):
+    return (ENTRY_DATA + 3 * capacity + 63) & ~63
+
+
+class Ring:
+    """Client side of the shared-memory batch ring."""
+
+    def __init__(self, name, num_entries, capacity):
+        self.num_entries = num_entries
+        self.capacity = capacity
+        self.esize = entry_size(capacity)
+        size = HEADER_SIZE + num_entries * self.esize
+        self.shm = shared_memory.SharedMemory(name=name, create=True, size=size)
+        self.buf = self.shm.buf
+        self.buf[:size] = bytes(size)
+        struct.pack_into("<IIII", self.buf, 0, RING_MAGIC, RING_VERSION, num_entries, capacity)
+        self.head = 0
+        self.completed = 0
+
+    def _entry(self, seq):
+        return HEADER_SIZE + (seq % self.num_entries) * self.esize
+
+    def tail(self):
+        return struct.unpack_from("<Q", self.buf, OFF_TAIL)[0]
+
+    def full(self):
+        # An entry is free again only once its results have been read back
+        return self.head - self.completed >= self.num_entries
+
+    def submit(self, nonce, first_index, symbols):
+        off = self._entry(self.head)
+        struct.pack_into("<QIIIIQ", self.buf, off, first_index, len(symbols), len(nonce), 0, 0, 0)
+        self.buf[off + 64:off + 64 + len(nonce)] = nonce
+        data = off + ENTRY_DATA
+        self.buf[data:data + len(symbols)] = bytes(symbols)
+        # Publish the entry only after its contents are written
+        self.head += 1
+        struct.pack_into("<Q", self.buf, OFF_HEAD, self.head)
+
+    def pop(self):
+        """Return (status, cycles, ciphertext, prf) of the oldest completed entry."""
+        off = self._entry(self.completed)
+        _, count, _, status, _, cycles = struct.unpack_from("<QIIIIQ", self.buf, off)
+        data = off + ENTRY_DATA
+        ct = bytes(self.buf[data + self.capacity:data + self.capacity + count])
+        prf = bytes(self.buf[data + 2 * self.capacity:data + 2 * self.capacity + count])
+        self.completed += 1
+        return status, cycles, ct, prf
+
+    def close(self):
+        struct.pack_into("<I", self.buf, OFF_SHUTDOWN, 1)
+        self.buf = None
+        self.shm.close()
+        self.shm.unlink()
+
+
+def build_server(repo_dir, build_dir, params):
+    cmd = ["verilator", "--cc", "--exe", "--build", "-O3", "-Wno-fatal",
+           "--top-module", TOP, "-Mdir", build_dir]
+    cmd += [f"-G{k}={v}" for k, v in params.items()]
+    cmd += [os.path.join(repo_dir, f) for f in RTL_SOURCES]
+    cmd += [os.path.join(repo_dir, "cosim_server.cpp")]
+    print("Building co-simulation server...")
+    subprocess.run(cmd, check=True)
+    print(f"✓ Server built in {build_dir}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Python <-> Verilated RTL co-simulation")
+    parser.add_argument("--build", action="store_true", help="(re)build the server first")
+    parser.add_argument("--build-dir", default="cosim_build")
+    parser.add_argument("--bytes", type=int, default=65536, help="message length in symbols")
+    parser.add_argument("--batch", type=int, default=1024, help="symbols per ring entry")
+    parser.add_argument("--entries", type=int, default=8, help="ring entries")
+    parser.add_argument("--nonce", default="lwr_seed", help="nonce (ASCII)")
+    parser.add_argument("--clock", type=float, default=100.0,
+                        help="clock in MHz for the hardware throughput estimate")
+    parser.add_argument("--check", type=int, default=4096,
+                        help="symbols to cross-check against encrypt_message (0 to skip)")
+    parser.add_argument("--run-dir",
+                        help="directory for the key files (default: a temporary one)")
+    args = parser.parse_args()
+
+    # Parameters matching hardware implementation
+    n, N, p = 445, 2048, 32
+    repo_dir = os.path.dirname(os.path.abspath(__file__))
+    build_dir = os.path.abspath(args.build_dir)
+    server = os.path.join(build_dir, f"V{TOP}")
+    nonce = args.nonce.encode()
+
+    if len(nonce) > MAX_NONCE:
+        print(f"Error: {NONCE_TOO_LONG}")
+        return 1
+
+    print("=" * 80)
+    print("LWR-PRF Co-Simulation")
+    print("=" * 80)
+    print(f"Parameters: n={n}, N={N}, p={p}")
+    print(f"Message: {args.bytes} symbols, nonce {nonce!r}, "
+          f"{args.entries} x {args.batch}-symbol ring")
+    print()
+
+    # The server reads secret_key.mem from the run directory, not the repo
+    if args.run_dir:
+        run_dir = os.path.abspath(args.run_dir)
+        os.makedirs(run_dir, exist_ok=True)
+    else:
+        tmp = tempfile.TemporaryDirectory(prefix="lwr_prf_cosim_")
+        run_dir = tmp.name
+    print(f"Run directory: {run_dir}")
+
+    prf = LWR_PRF_Client(n=n, N=N, p=p, seed=42,
+                         key_file=os.path.join(run_dir, "secret_key.json"))
+    with open(os.path.join(run_dir, "secret_key.mem"), "w") as f:
+        for bit in prf.s:
+            f.write(f"{bit}\n")
+    print()
+
+    if args.build or not os.path.exists(server):
+        build_server(repo_dir, build_dir, {"N_LWR": n, "N": N, "P": p})
+
+    rng = np.random.default_rng(1)
+    message = rng.integers(0, p, size=args.bytes, dtype=np.uint8)
+
+    ring = Ring(f"lwr_prf_cosim_{os.getpid()}", args.entries, args.batch)
+    proc = subprocess.Popen([server, "/" + ring.shm.name, run_dir])
+
+    ciphertext = bytearray(args.bytes)
+    prf_stream = bytearray(args.bytes)
+    total_cycles = 0
+    errors = 0
+    offset = 0
+
+    start = time.perf_counter()
+    try:
+        while ring.completed < ring.head or offset < args.bytes:
+            if offset < args.bytes and not ring.full():
+                count = min(args.batch, args.bytes - offset)
+                ring.submit(nonce, offset, message[offset:offset + count].tobytes())
+                offset += count
+                continue
+
+            if ring.tail() > ring.completed:
+                batch = ring.completed
+                status, cycles, ct, stream = ring.pop()
+                base = batch * args.batch
+                ciphertext[base:base + len(ct)] = ct
+                prf_stream[base:base + len(stream)] = stream
+                total_cycles += cycles
+                if status != 0:
+                    print(f"✗ Batch {batch}: {STATUS_NAMES.get(status, status)}")
+                    errors += 1
+            elif proc.poll() is not None:
+                print("✗ Server exited unexpectedly")
+                return 1
+            else:
+                time.sleep(0)
+    finally:
+        ring.close()
+        proc.wait(timeout=10)
+    wall = time.perf_counter() - start
+
+    print()
+    print("Throughput:")
+    print(f"  Wall clock:          {wall:.2f} s ({args.bytes / wall:.0f} symbols/s simulated)")
+    if total_cycles:
+        cycles_per_symbol = total_cycles / args.bytes
+        print(f"  Cycles per symbol:   {cycles_per_symbol:.1f}")
+        print(f"  Hardware @ {args.clock:.0f} MHz:  "
+              f"{args.clock * 1e6 / cycles_per_symbol:.0f} symbols/s")
+    print()
+
+    if errors:
+        print(f"✗ {errors} batch(es) were not evaluated by the RTL")
+        return 1
+
+    # The Python PRF is slow, so only a prefix of the message is checked
+    checked = min(args.check, args.bytes)
+    if checked > 0:
+        print(f"Cross-checking {checked} symbols against encrypt_message...")
+        _, expected = prf.encrypt_message([int(m) for m in message[:checked]], nonce)
+        mismatches = [i for i, (c, e) in enumerate(zip(ciphertext, expected)) if c != e]
+        if mismatches:
+            first = mismatches[0]
+            print(f"✗ {len(mismatches)} of {checked} symbols differ "
+                  f"(first at index {first}: RTL {ciphertext[first]}, "
+                  f"Python {expected[first]}, RTL PRF {prf_stream[first]})")
+            return 1
+        print(f"✓ First {checked} ciphertext symbols match encrypt_message")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,296 @@
+// Co-simulation server: Verilated prf_evaluate_message behind a
+// shared-memory ring, driven by cosim_client.py.
+//
+// The client creates a POSIX shared-memory segment holding a ring of
+// batches. Each batch is (nonce, first_index, count, plaintext[count]).
+// The nonce is streamed into the RTL only when it differs from the
+// previous batch's. The server streams every slot of a batch through the
+// RTL request queue
+// (results come back in order, tagged with prf_index), writes
+// ciphertext[] and prf[] back into the same entry and advances the
+// completion counter. The client never waits on a socket or
+// pipe, it only polls the counters.
+//
+// Shared-memory layout (little-endian, offsets in bytes):
+//   Header (64 bytes)
+//     0  u32 magic (RING_MAGIC)      4  u32 version
+//     8  u32 num_entries            12  u32 capacity (symbols per entry)
+//    16  u64 head (batches submitted by the client)
+//    24  u64 tail (batches completed by the server)
+//    32  u32 shutdown
+//   Entry i at 64 + i * entry_size, entry_size = 128 + 3 * capacity
+//   rounded up to 64:
+//     0  u64 first_index            8  u32 count
+//    12  u32 nonce_len             16  u32 status (STATUS_*)
+//    24  u64 cycles (simulated clock cycles for this batch)
+//    64  u8  nonce[MAX_NONCE]        (MAX_NONCE = 64; longer nonces are
+//                                        rejected with STATUS_NONCE_TOO_LONG)
+//   128  u8  plaintext[capacity]
+//        u8  ciphertext[capacity]
+//        u8  prf[capacity]
+//
+// Built by cosim_client.py --build; by hand:
+//   verilator --cc --exe --build -O3 --top-module prf_evaluate_message -Wno-fatal
+//       <rtl sources> cosim_server.cpp
+//   ./obj_dir/Vprf_evaluate_message <shm name> [run dir]
+// The key store's KEY_FILE (secret_key.mem) is read from the run directory,
+// or the working directory if none is given.
+
+#include "Vprf_evaluate_message.h"
+#include "verilated.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const uint32_t RING_MAGIC = 0x5052574c; // "LWRP"
+static const uint32_t RING_VERSION = 1;
+static const size_t HEADER_SIZE = 64;
+static const size_t ENTRY_DATA = 128;
+static const size_t MAX_NONCE = 64;
+static const uint64_t SLOT_TIMEOUT = 1u << 20;
+
+enum Status : uint32_t {
+    STATUS_OK = 0,
+    STATUS_NONCE_TOO_LONG = 1, // nonce_len exceeds the entry's nonce field
+    STATUS_TIMEOUT = 2,
+};
+
+struct RingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_entries;
+    uint32_t capacity;
+    uint64_t head;
+    uint64_t tail;
+    uint32_t shutdown;
+};
+
+struct EntryHeader {
+    uint64_t first_index;
+    uint32_t count;
+    uint32_t nonce_len;
+    uint32_t status;
+    uint32_t reserved;
+    uint64_t cycles;
+};
+
+static size_t entry_size(uint32_t capacity) {
+    size_t size = ENTRY_DATA + 3 * (size_t)capacity;
+    return (size + 63) & ~(size_t)63;
+}
+
+class Simulator {
+public:
+    Simulator() : ctx_(new VerilatedContext), top_(ctx_.get()) {
+        top_.rst_n = 0;
+        top_.start = 0;
+        top_.nonce_valid = 0;
+        top_.key_wr_en = 0;
+        top_.key_swap = 0;
+        top_.perf_wr_en = 0;
+        top_.perf_rd_en = 0;
+        for (int i = 0; i < 4; i++)
+            tick();
+        top_.rst_n = 1;
+        tick();
+    }
+
+    ~Simulator() { top_.final(); }
+
+    uint64_t cycles() const { return cycles_; }
+
+    // Stream a nonce in 8-byte beats unless it is already loaded; returns
+    // false on timeout
+    bool load_nonce(const uint8_t *nonce, uint32_t len) {
+        if (nonce_loaded_ && len == nonce_len_ && !memcmp(nonce, nonce_, len))
+            return true;
+
+        uint32_t sent = 0;
+        uint64_t waited = 0;
+        bool last = false;
+        while (!last) {
+            uint32_t take = len - sent < 8 ? len - sent : 8;
+            uint64_t data = 0;
+            for (uint32_t b = 0; b < take; b++)
+                data |= (uint64_t)nonce[sent + b] << (8 * b);
+            top_.nonce_data = data;
+            top_.nonce_keep = (uint8_t)((1u << take) - 1);
+            top_.nonce_last = (sent + take == len);
+            top_.nonce_valid = 1;
+            top_.eval();
+            bool accept = top_.nonce_ready;
+            tick();
+            if (accept) {
+                sent += take;
+                last = top_.nonce_last;
+                waited = 0;
+            }
+            else if (++waited > SLOT_TIMEOUT) {
+                top_.nonce_valid = 0;
+                nonce_loaded_ = false;
+                return false;
+            }
+        }
+        top_.nonce_valid = 0;
+
+        memcpy(nonce_, nonce, len);
+        nonce_len_ = len;
+        nonce_loaded_ = true;
+        return true;
+    }
+
+    // Evaluate count consecutive slots, keeping the request queue full;
+    // returns false on timeout or an out-of-order result
+    bool evaluate(uint64_t first_index, uint32_t count,
+                  const uint8_t *plaintext, uint8_t *ciphertext, uint8_t *prf) {
+        uint32_t pushed = 0, completed = 0;
+        uint64_t last_progress = cycles_;
+
+        while (completed < count) {
+            // ciphertext is combinational on the completing slot's symbol
+            top_.plaintext = plaintext[completed];
+            top_.index = first_index + pushed;
+            top_.start = (pushed < count) && top_.ready;
+            bool push = top_.start;
+            tick();
+            top_.start = 0;
+            if (push)
+                pushed++;
+
+            if (top_.done) {
+                if (top_.prf_index != first_index + completed)
+                    return false;
+                ciphertext[completed] = (uint8_t)top_.ciphertext;
+                prf[completed] = (uint8_t)top_.prf_out;
+                completed++;
+                last_progress = cycles_;
+            }
+            else if (cycles_ - last_progress > SLOT_TIMEOUT) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    void tick() {
+        top_.clk = 0;
+        top_.eval();
+        top_.clk = 1;
+        top_.eval();
+        cycles_++;
+    }
+
+    std::unique_ptr<VerilatedContext> ctx_;
+    Vprf_evaluate_message top_;
+    uint64_t cycles_ = 0;
+    uint8_t nonce_[MAX_NONCE];
+    uint32_t nonce_len_ = 0;
+    bool nonce_loaded_ = false;
+};
+
+static void process_entry(Simulator& sim, uint8_t *entry, uint32_t capacity) {
+    EntryHeader *eh = (EntryHeader *)entry;
+    uint8_t *nonce_bytes = entry + 64;
+    uint8_t *plaintext = entry + ENTRY_DATA;
+    uint8_t *ciphertext = plaintext + capacity;
+    uint8_t *prf = ciphertext + capacity;
+
+    uint32_t count = eh->count < capacity ? eh->count : capacity;
+    uint64_t begin = sim.cycles();
+    eh->status = STATUS_OK;
+
+    if (eh->nonce_len > MAX_NONCE) {
+        // Same message as cosim_client.py
+        fprintf(stderr, "Error: nonce longer than %zu bytes\n", MAX_NONCE);
+        eh->status = STATUS_NONCE_TOO_LONG;
+        eh->cycles = 0;
+        return;
+    }
+
+    if (!sim.load_nonce(nonce_bytes, eh->nonce_len) ||
+        !sim.evaluate(eh->first_index, count, plaintext, ciphertext, prf))
+        eh->status = STATUS_TIMEOUT;
+    eh->cycles = sim.cycles() - begin;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <shm name> [run dir]\n", argv[0]);
+        return 1;
+    }
+    if (argc > 2 && chdir(argv[2]) < 0) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    const char *name = argv[1];
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        perror("shm_open");
+        return 1;
+    }
+
+    struct stat sb;
+    if (fstat(fd, &sb) < 0 || (size_t)sb.st_size < HEADER_SIZE) {
+        fprintf(stderr, "Error: shared memory segment %s is too small\n", name);
+        return 1;
+    }
+
+    uint8_t *base = (uint8_t *)mmap(nullptr, sb.st_size, PROT_READ | PROT_WRITE,
+                                    MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    RingHeader *hdr = (RingHeader *)base;
+    if (hdr->magic != RING_MAGIC || hdr->version != RING_VERSION) {
+        fprintf(stderr, "Error: bad ring header (magic %08x, version %u)\n",
+                hdr->magic, hdr->version);
+        return 1;
+    }
+
+    const uint32_t num_entries = hdr->num_entries;
+    const uint32_t capacity = hdr->capacity;
+    const size_t esize = entry_size(capacity);
+    if (HEADER_SIZE + num_entries * esize > (size_t)sb.st_size) {
+        fprintf(stderr, "Error: ring does not fit in shared memory segment\n");
+        return 1;
+    }
+
+    fprintf(stderr, "cosim_server: %u entries x %u symbols\n", num_entries, capacity);
+
+    Simulator sim;
+    uint64_t tail = __atomic_load_n(&hdr->tail, __ATOMIC_ACQUIRE);
+    unsigned idle = 0;
+
+    while (!__atomic_load_n(&hdr->shutdown, __ATOMIC_ACQUIRE)) {
+        uint64_t head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+        if (tail == head) {
+            // Spin briefly, then back off so an idle server does not burn a core
+            if (++idle > 1000)
+                usleep(100);
+            continue;
+        }
+        idle = 0;
+
+        uint8_t *entry = base + HEADER_SIZE + (tail % num_entries) * esize;
+        process_entry(sim, entry, capacity);
+
+        tail++;
+        __atomic_store_n(&hdr->tail, tail, __ATOMIC_RELEASE);
+    }
+
+    fprintf(stderr, "cosim_server: %llu cycles simulated\n",
+            (unsigned long long)sim.cycles());
+    munmap(base, sb.st_size);
+    return 0;
+}
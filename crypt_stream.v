@@ -0,0 +1,91 @@
+// W-symbol stream encryption: output lane i = (input lane i + keystream
+// lane i) mod P, or with DECRYPT (input lane i - keystream lane i) mod P,
+// the plaintext again (encrypt/decrypt per lane). Symbols sit in the
+// low bits of byte-aligned lanes (LANE_WIDTH bits each). An input beat is
+// joined with one keystream beat; tkeep and tlast follow the input and
+// lanes with tkeep low still consume keystream. The output goes through a
+// skid_buffer, so backpressure on m_axis_* reaches both inputs through a
+// registered ready.
+module crypt_stream #(
+    parameter P = 32,
+    parameter W = 8,      // symbols per beat
+    parameter DECRYPT = 0 // 0: encrypt.v per lane, 1: decrypt.v
+) (
+    input wire clk,
+    input wire rst_n,
+
+    // Plaintext (ciphertext with DECRYPT)
+    input wire [W*(($clog2(P) + 7) / 8)*8-1:0] s_axis_tdata,
+    input wire [W*(($clog2(P) + 7) / 8)-1:0] s_axis_tkeep,
+    input wire s_axis_tvalid,
+    output wire s_axis_tready,
+    input wire s_axis_tlast,
+
+    // Keystream (PRF outputs)
+    input wire [W*(($clog2(P) + 7) / 8)*8-1:0] key_axis_tdata,
+    input wire key_axis_tvalid,
+    output wire key_axis_tready,
+
+    // Ciphertext (plaintext with DECRYPT)
+    output wire [W*(($clog2(P) + 7) / 8)*8-1:0] m_axis_tdata,
+    output wire [W*(($clog2(P) + 7) / 8)-1:0] m_axis_tkeep,
+    output wire m_axis_tvalid,
+    input wire m_axis_tready,
+    output wire m_axis_tlast
+);
+
+    localparam WIDTH = $clog2(P);
+    localparam LANE_BYTES = (WIDTH + 7) / 8;
+    localparam LANE_WIDTH = LANE_BYTES * 8;
+    localparam DATA_WIDTH = W * LANE_WIDTH;
+    localparam KEEP_WIDTH = W * LANE_BYTES;
+
+    wire [DATA_WIDTH-1:0] result;
+
+    genvar i;
+    generate
+        for (i = 0; i < W; i = i + 1) begin : lane
+            wire [WIDTH-1:0] symbol;
+            if (DECRYPT) begin : dec_lane
+                decrypt #(
+                    .P(P)
+                ) dec (
+                    .ciphertext(s_axis_tdata[i*LANE_WIDTH +: WIDTH]),
+                    .prf_out(key_axis_tdata[i*LANE_WIDTH +: WIDTH]),
+                    .plaintext(symbol)
+                );
+            end
+            else begin : enc_lane
+                encrypt #(
+                    .P(P)
+                ) enc (
+                    .plaintext(s_axis_tdata[i*LANE_WIDTH +: WIDTH]),
+                    .prf_out(key_axis_tdata[i*LANE_WIDTH +: WIDTH]),
+                    .ciphertext(symbol)
+                );
+            end
+            assign result[i*LANE_WIDTH +: LANE_WIDTH] = symbol; // zero-extended
+        end
+    endgenerate
+
+    // Join: a beat moves when both inputs are valid and the skid buffer
+    // can take it
+    wire out_ready;
+    wire join_valid = s_axis_tvalid && key_axis_tvalid;
+    assign s_axis_tready = key_axis_tvalid && out_ready;
+    assign key_axis_tready = s_axis_tvalid && out_ready;
+
+    skid_buffer #(
+        .DATA_WIDTH(DATA_WIDTH + KEEP_WIDTH + 1)
+    ) out_buf (
+        .clk(clk),
+        .rst_n(rst_n),
+        .s_data({s_axis_tlast, s_axis_tkeep, result}),
+        .s_valid(join_valid),
+        .s_ready(out_ready),
+        .m_data({m_axis_tlast, m_axis_tkeep, m_axis_tdata}),
+        .m_valid(m_axis_tvalid),
+        .m_ready(m_axis_tready)
+    );
+
+endmodule
@@ -0,0 +1,248 @@
+`timescale 1ns / 1ps
+
+module crypt_stream_tb;
+    // Parameters
+    localparam P = 32;
+    localparam W = 4;               // symbols per beat
+    localparam LANE_WIDTH = 8;      // $clog2(P) = 5 bits in a byte lane
+    localparam DATA_WIDTH = W * LANE_WIDTH;
+    localparam BEATS = 3;
+    localparam CLK_PERIOD = 10; // 10ns = 100MHz
+
+    // Signals
+    reg clk;
+    reg rst_n;
+
+    // Plaintext source -> crypt_stream -> crypt_stream (DECRYPT) -> sink
+    reg [DATA_WIDTH-1:0] p_tdata;
+    reg [W-1:0] p_tkeep;
+    reg p_tvalid;
+    wire p_tready;
+    reg p_tlast;
+
+    reg [DATA_WIDTH-1:0] ek_tdata;
+    reg ek_tvalid;
+    wire ek_tready;
+
+    wire [DATA_WIDTH-1:0] c_tdata;
+    wire [W-1:0] c_tkeep;
+    wire c_tvalid;
+    wire c_tready;
+    wire c_tlast;
+
+    reg [DATA_WIDTH-1:0] dk_tdata;
+    reg dk_tvalid;
+    wire dk_tready;
+
+    wire [DATA_WIDTH-1:0] d_tdata;
+    wire [W-1:0] d_tkeep;
+    wire d_tvalid;
+    reg d_tready;
+    wire d_tlast;
+
+    // Instantiate the encrypting crypt_stream
+    crypt_stream #(
+        .P(P),
+        .W(W),
+        .DECRYPT(0)
+    ) enc (
+        .clk(clk),
+        .rst_n(rst_n),
+        .s_axis_tdata(p_tdata),
+        .s_axis_tkeep(p_tkeep),
+        .s_axis_tvalid(p_tvalid),
+        .s_axis_tready(p_tready),
+        .s_axis_tlast(p_tlast),
+        .key_axis_tdata(ek_tdata),
+        .key_axis_tvalid(ek_tvalid),
+        .key_axis_tready(ek_tready),
+        .m_axis_tdata(c_tdata),
+        .m_axis_tkeep(c_tkeep),
+        .m_axis_tvalid(c_tvalid),
+        .m_axis_tready(c_tready),
+        .m_axis_tlast(c_tlast)
+    );
+
+    // Instantiate the decrypting crypt_stream
+    crypt_stream #(
+        .P(P),
+        .W(W),
+        .DECRYPT(1)
+    ) dec (
+        .clk(clk),
+        .rst_n(rst_n),
+        .s_axis_tdata(c_tdata),
+        .s_axis_tkeep(c_tkeep),
+        .s_axis_tvalid(c_tvalid),
+        .s_axis_tready(c_tready),
+        .s_axis_tlast(c_tlast),
+        .key_axis_tdata(dk_tdata),
+        .key_axis_tvalid(dk_tvalid),
+        .key_axis_tready(dk_tready),
+        .m_axis_tdata(d_tdata),
+        .m_axis_tkeep(d_tkeep),
+        .m_axis_tvalid(d_tvalid),
+        .m_axis_tready(d_tready),
+        .m_axis_tlast(d_tlast)
+    );
+
+    // Clock generation
+    initial begin
+        clk = 0;
+        forever #(CLK_PERIOD/2) clk = ~clk;
+    end
+
+    // Same message and PRF outputs as encrypt_decrypt_tb, plus its
+    // zero/max edge cases; the last beat has two symbols (tkeep 4'b0011)
+    reg [LANE_WIDTH-1:0] plaintexts [0:BEATS*W-1];
+    reg [LANE_WIDTH-1:0] prf_outputs [0:BEATS*W-1];
+    reg [W-1:0] beat_keep [0:BEATS-1];
+
+    function [DATA_WIDTH-1:0] pack;
+        input integer beat;
+        input integer which; // 0: plaintext, 1: prf output, 2: expected ciphertext
+        integer l;
+        begin
+            pack = {DATA_WIDTH{1'b0}};
+            for (l = 0; l < W; l = l + 1) begin
+                if (beat_keep[beat][l]) begin
+                    case (which)
+                        0: pack[l*LANE_WIDTH +: LANE_WIDTH] = plaintexts[beat*W + l];
+                        1: pack[l*LANE_WIDTH +: LANE_WIDTH] = prf_outputs[beat*W + l];
+                        default: pack[l*LANE_WIDTH +: LANE_WIDTH] =
+                            (plaintexts[beat*W + l] + prf_outputs[beat*W + l]) % P;
+                    endcase
+                end
+            end
+        end
+    endfunction
+
+    // Backpressure: d_tready low every third cycle
+    integer cycle;
+    always @(posedge clk) begin
+        if (!rst_n)
+            cycle <= 0;
+        else
+            cycle <= cycle + 1;
+    end
+    always @(negedge clk)
+        d_tready <= (cycle % 3) != 2;
+
+    // Sources: the next beat is presented as soon as the last one moves
+    integer p_sent, ek_sent, dk_sent;
+    always @(posedge clk) begin
+        if (rst_n) begin
+            if (p_tvalid && p_tready) p_sent = p_sent + 1;
+            if (ek_tvalid && ek_tready) ek_sent = ek_sent + 1;
+            if (dk_tvalid && dk_tready) dk_sent = dk_sent + 1;
+        end
+    end
+    always @(negedge clk) begin
+        p_tvalid <= rst_n && (p_sent < BEATS);
+        p_tdata <= (p_sent < BEATS) ? pack(p_sent, 0) : {DATA_WIDTH{1'b0}};
+        p_tkeep <= (p_sent < BEATS) ? beat_keep[p_sent] : {W{1'b0}};
+        p_tlast <= (p_sent == BEATS - 1);
+        ek_tvalid <= rst_n && (ek_sent < BEATS);
+        ek_tdata <= (ek_sent < BEATS) ? pack(ek_sent, 1) : {DATA_WIDTH{1'b0}};
+        // Decrypt keystream arrives late and with a gap
+        dk_tvalid <= rst_n && (dk_sent < BEATS) && (cycle > 4) && (cycle != 7);
+        dk_tdata <= (dk_sent < BEATS) ? pack(dk_sent, 1) : {DATA_WIDTH{1'b0}};
+    end
+
+    // Check the ciphertext and decrypted streams on every transfer
+    integer c_received, d_received;
+    integer errors;
+    always @(posedge clk) begin
+        if (rst_n && c_tvalid && c_tready) begin
+            if (c_received < BEATS && c_tdata == pack(c_received, 2) &&
+                c_tkeep == beat_keep[c_received] && c_tlast == (c_received == BEATS - 1)) begin
+                $display("    ✓ PASS: ciphertext beat %0d = 0x%08h", c_received, c_tdata);
+            end
+            else begin
+                $display("    ✗ FAIL: ciphertext beat %0d = 0x%08h keep=%b last=%0d",
+                         c_received, c_tdata, c_tkeep, c_tlast);
+                errors = errors + 1;
+            end
+            c_received = c_received + 1;
+        end
+        if (rst_n && d_tvalid && d_tready) begin
+            if (d_received < BEATS && d_tdata == pack(d_received, 0) &&
+                d_tkeep == beat_keep[d_received] && d_tlast == (d_received == BEATS - 1)) begin
+                $display("    ✓ PASS: decrypted beat %0d = 0x%08h%s", d_received, d_tdata,
+                         d_tlast ? " (TLAST)" : "");
+            end
+            else begin
+                $display("    ✗ FAIL: decrypted beat %0d = 0x%08h keep=%b last=%0d",
+                         d_received, d_tdata, d_tkeep, d_tlast);
+                errors = errors + 1;
+            end
+            d_received = d_received + 1;
+        end
+    end
+
+    integer i;
+    initial begin
+        plaintexts[0] = 10;  prf_outputs[0] = 16;
+        plaintexts[1] = 20;  prf_outputs[1] = 12;
+        plaintexts[2] = 15;  prf_outputs[2] = 7;
+        plaintexts[3] = 8;   prf_outputs[3] = 19;
+        plaintexts[4] = 31;  prf_outputs[4] = 2;
+        plaintexts[5] = 18;  prf_outputs[5] = 14;
+        plaintexts[6] = 0;   prf_outputs[6] = 23;
+        plaintexts[7] = 21;  prf_outputs[7] = 9;
+        plaintexts[8] = 0;   prf_outputs[8] = 15;
+        plaintexts[9] = 31;  prf_outputs[9] = 31;
+        plaintexts[10] = 0;  prf_outputs[10] = 0; // tkeep low
+        plaintexts[11] = 0;  prf_outputs[11] = 0; // tkeep low
+        beat_keep[0] = 4'b1111;
+        beat_keep[1] = 4'b1111;
+        beat_keep[2] = 4'b0011;
+
+        p_sent = 0;
+        ek_sent = 0;
+        dk_sent = 0;
+        c_received = 0;
+        d_received = 0;
+        errors = 0;
+
+        // Initialize signals
+        rst_n = 0;
+        p_tvalid = 0;
+        ek_tvalid = 0;
+        dk_tvalid = 0;
+        d_tready = 0;
+
+        $display("================================================================================");
+        $display("Encrypt/Decrypt Stream Testbench");
+        $display("================================================================================");
+        $display("Parameters: P=%0d, W=%0d symbols per beat", P, W);
+        $display("");
+
+        // Release reset
+        #(CLK_PERIOD * 2);
+        rst_n = 1;
+
+        $display("Test Case 1: %0d-beat loopback with backpressure", BEATS);
+        wait(d_received == BEATS);
+        #(CLK_PERIOD * 10);
+        $display("");
+
+        if (errors == 0 && c_received == BEATS && d_received == BEATS)
+            $display("✓ All %0d beats round-trip", BEATS);
+        else
+            $display("✗ %0d error(s), %0d of %0d beats received", errors, d_received, BEATS);
+
+        $display("================================================================================");
+        $display("Simulation Complete");
+        $display("================================================================================");
+        $finish;
+    end
+
+    // Timeout watchdog
+    initial begin
+        #(CLK_PERIOD * 1000); // 1000 cycles timeout
+        $display("ERROR: Simulation timeout!");
+        $finish;
+    end
+
+endmodule
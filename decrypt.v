@@ -6,9 +6,10 @@ module decrypt #(
     output wire [$clog2(P)-1:0] plaintext
 );
     localparam WIDTH = $clog2(P);
+    localparam POW2 = (P == (1 << WIDTH)); // mod P is the low WIDTH bits
 
     wire [WIDTH:0] diff; // one extra bit for overflow
-    assign diff = ciphertext + P - prf_out;
-    assign plaintext = (diff >= P) ? (diff - P) : diff[WIDTH-1:0];
+    assign diff = POW2 ? ciphertext - prf_out : ciphertext + P - prf_out;
+    assign plaintext = (!POW2 && diff >= P) ? (diff - P) : diff[WIDTH-1:0];
 
-endmodule
\ No newline at end of file
+endmodule
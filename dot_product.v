@@ -1,52 +1,114 @@
+// <a, s_k> for NUM_KEYS keys over a stream of LANES-element beats. Element
+// i of a beat is a_in[i*ELEM_WIDTH +: ELEM_WIDTH], counted for key k when
+// a_mask[i] and key_bits[k*LANES + i] are set; the beat with a_last may be
+// partial. Each key selects its elements into its own registered adder
+// tree ($clog2(LANES) levels, one add per level) and accumulator; done
+// rises $clog2(LANES) + 1 clock edges after the edge that samples the last
+// beat with every key's result in dot_product[k*ACC_WIDTH +: ACC_WIDTH].
+//
+// All sums are modulo 2^ACC_WIDTH: prf_rounding only reads the low
+// log2(2N) bits, so ACC_WIDTH = ELEM_WIDTH keeps every adder that narrow.
 module dot_product #(
     parameter N_LWR = 445,
     parameter ELEM_WIDTH = 12,
-    parameter ACC_WIDTH = 32
+    parameter ACC_WIDTH = 32,
+    parameter LANES = 1,
+    parameter NUM_KEYS = 1
 ) (
     input wire clk,
     input wire rst_n,
     input wire start,
 
-    input wire [ELEM_WIDTH-1:0] a_in,
+    input wire [LANES*ELEM_WIDTH-1:0] a_in,
+    input wire [LANES-1:0] a_mask,
     input wire a_valid,
     input wire a_last,
 
-    input wire key_bit,
-    
-    output reg [ACC_WIDTH-1:0] dot_product,
+    input wire [NUM_KEYS*LANES-1:0] key_bits,
+
+    output wire [NUM_KEYS*ACC_WIDTH-1:0] dot_product,
     output reg done
 );
 
-    reg [ACC_WIDTH-1:0] accumulator;
-    always @(posedge clk or negedge rst_n) begin
-        if (!rst_n) begin
-            accumulator <= {ACC_WIDTH{1'b0}};
-        end
-        else if (start) begin
-            accumulator <= 0;
-        end
-        else if (key_bit && a_valid) begin // if the key bit is 1 then add a
-            accumulator <= accumulator + a_in;
-        end
+    localparam LEVELS = (LANES > 1) ? $clog2(LANES) : 0;
+    localparam TREE_LANES = 1 << LEVELS;
+    localparam SUM_WIDTH = (ELEM_WIDTH + LEVELS < ACC_WIDTH) ? ELEM_WIDTH + LEVELS : ACC_WIDTH;
+
+    // Element lanes padded to a power of two, unused leaves read as zero
+    reg [TREE_LANES*ELEM_WIDTH-1:0] a_pad;
+    always @(*) begin
+        a_pad = {TREE_LANES*ELEM_WIDTH{1'b0}};
+        a_pad[LANES*ELEM_WIDTH-1:0] = a_in;
     end
 
+    // Beat valid/last travel alongside the tree levels, shared by all keys
+    reg [LEVELS:0] pipe_valid;
+    reg [LEVELS:0] pipe_last;
+
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
-            dot_product <= {ACC_WIDTH{1'b0}};
-            done <= 0;
+            pipe_valid <= 0;
+            pipe_last <= 0;
+            done <= 1'b0;
         end
         else begin
-            done <= 0;
-            if (a_valid && a_last) begin
-                if (key_bit) begin
-                    dot_product <= accumulator + a_in;
+            pipe_valid <= (pipe_valid << 1) | a_valid;
+            pipe_last <= (pipe_last << 1) | (a_valid && a_last);
+            done <= pipe_valid[LEVELS] && pipe_last[LEVELS] && !start;
+        end
+    end
+
+    wire tree_valid = pipe_valid[LEVELS];
+    wire tree_last = pipe_last[LEVELS];
+
+    genvar k;
+    generate
+        for (k = 0; k < NUM_KEYS; k = k + 1) begin : key_lane
+            reg [TREE_LANES-1:0] sel_pad;
+            always @(*) begin
+                sel_pad = {TREE_LANES{1'b0}};
+                sel_pad[LANES-1:0] = a_mask & key_bits[k*LANES +: LANES];
+            end
+
+            // tree[l][i]: node i of level l; level 0 holds the selected elements
+            reg [SUM_WIDTH-1:0] tree [0:LEVELS][0:TREE_LANES-1];
+
+            integer l, i;
+            always @(posedge clk) begin
+                for (i = 0; i < TREE_LANES; i = i + 1)
+                    tree[0][i] <= sel_pad[i] ? a_pad[i*ELEM_WIDTH +: ELEM_WIDTH] : {ELEM_WIDTH{1'b0}};
+                for (l = 1; l <= LEVELS; l = l + 1)
+                    for (i = 0; i < (TREE_LANES >> l); i = i + 1)
+                        tree[l][i] <= tree[l-1][2*i] + tree[l-1][2*i+1];
+            end
+
+            // Accumulator, modulo 2^ACC_WIDTH. At ACC_WIDTH = ELEM_WIDTH a
+            // plain adder is the narrowest form: a carry-save pair would
+            // double the accumulator flops to save a 12-bit carry chain.
+            reg [ACC_WIDTH-1:0] acc;
+            reg [ACC_WIDTH-1:0] result;
+            wire [ACC_WIDTH-1:0] tree_ext = tree[LEVELS][0];
+            wire [ACC_WIDTH-1:0] acc_next = acc + tree_ext;
+
+            always @(posedge clk or negedge rst_n) begin
+                if (!rst_n) begin
+                    acc <= {ACC_WIDTH{1'b0}};
+                    result <= {ACC_WIDTH{1'b0}};
                 end
                 else begin
-                    dot_product <= accumulator;
+                    if (start)
+                        acc <= 0;
+                    else if (tree_valid && tree_last) begin // result goes to dot_product, ready for the next vector
+                        result <= acc_next;
+                        acc <= 0;
+                    end
+                    else if (tree_valid)
+                        acc <= acc_next;
                 end
-                done <= 1'b1;
             end
+
+            assign dot_product[k*ACC_WIDTH +: ACC_WIDTH] = result;
         end
-    end
+    endgenerate
 
-endmodule
\ No newline at end of file
+endmodule
@@ -0,0 +1,173 @@
+// Bit-plane form of dot_product (same ports and result): s is binary, so
+// <a, s> = sum_b 2^b * popcount(plane_b(a) & s), plane_b(a) being bit b of
+// every element.
+//
+// Elements are buffered until the next beat might overflow BLOCK_ELEMS
+// (one rate block of hash_to_vector output; with LANES > 1 the groups need
+// not line up with rate blocks) or a_last, then moved as bit-planes with
+// each key's packed key word to the popcount stage. The ELEM_WIDTH
+// popcounts per key are registered and combined with their weights into
+// the accumulator, so done rises 2 clock edges after the edge that
+// samples the last beat. Sums are modulo 2^ACC_WIDTH as in dot_product.
+module dot_product_bitplane #(
+    parameter N_LWR = 445,
+    parameter ELEM_WIDTH = 12,
+    parameter ACC_WIDTH = 32,
+    parameter LANES = 1,
+    parameter NUM_KEYS = 1,
+    parameter BLOCK_ELEMS = 17 // elements per popcount, >= LANES
+) (
+    input wire clk,
+    input wire rst_n,
+    input wire start,
+
+    input wire [LANES*ELEM_WIDTH-1:0] a_in,
+    input wire [LANES-1:0] a_mask,
+    input wire a_valid,
+    input wire a_last,
+
+    input wire [NUM_KEYS*LANES-1:0] key_bits,
+
+    output wire [NUM_KEYS*ACC_WIDTH-1:0] dot_product,
+    output reg done
+);
+
+    localparam FILL_WIDTH = $clog2(BLOCK_ELEMS + 1);
+    localparam CNT_WIDTH = $clog2(BLOCK_ELEMS + 1);
+
+    // Number of set bits of a plane
+    function [CNT_WIDTH-1:0] popcount;
+        input [BLOCK_ELEMS-1:0] bits;
+        integer j;
+        begin
+            popcount = 0;
+            for (j = 0; j < BLOCK_ELEMS; j = j + 1)
+                popcount = popcount + bits[j];
+        end
+    endfunction
+
+    // Block buffer: element j of the block in buf_elem[j*ELEM_WIDTH +:
+    // ELEM_WIDTH] (zero where the mask was low), key k's bit in key_buf
+    reg [BLOCK_ELEMS*ELEM_WIDTH-1:0] buf_elem;
+    reg [NUM_KEYS*BLOCK_ELEMS-1:0] key_buf;
+    reg [FILL_WIDTH-1:0] fill;
+
+    // Buffer with this beat written at fill
+    reg [BLOCK_ELEMS*ELEM_WIDTH-1:0] elem_next;
+    reg [NUM_KEYS*BLOCK_ELEMS-1:0] key_next;
+    reg [FILL_WIDTH:0] fill_next;
+    integer i, j, kk;
+    always @(*) begin
+        elem_next = buf_elem;
+        key_next = key_buf;
+        fill_next = fill;
+        for (i = 0; i < LANES; i = i + 1) begin
+            if (a_mask[i]) begin
+                for (j = 0; j < BLOCK_ELEMS; j = j + 1) begin
+                    if (fill + i == j) begin
+                        elem_next[j*ELEM_WIDTH +: ELEM_WIDTH] = a_in[i*ELEM_WIDTH +: ELEM_WIDTH];
+                        for (kk = 0; kk < NUM_KEYS; kk = kk + 1)
+                            key_next[kk*BLOCK_ELEMS + j] = key_bits[kk*LANES + i];
+                    end
+                end
+                fill_next = fill_next + 1'd1;
+            end
+        end
+    end
+
+    // Flush once the next beat might not fit, and at the end of the vector
+    wire flush = a_valid && (a_last || fill_next > BLOCK_ELEMS - LANES);
+
+    // Popcount stage input: bit-planes of the flushed block
+    reg [ELEM_WIDTH*BLOCK_ELEMS-1:0] planes; // plane b in [b*BLOCK_ELEMS +: BLOCK_ELEMS]
+    reg [NUM_KEYS*BLOCK_ELEMS-1:0] key_words;
+    reg p_valid, p_last;
+    reg c_valid, c_last;
+    integer pi, pj;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            buf_elem <= {BLOCK_ELEMS*ELEM_WIDTH{1'b0}};
+            key_buf <= {NUM_KEYS*BLOCK_ELEMS{1'b0}};
+            fill <= 0;
+            planes <= {ELEM_WIDTH*BLOCK_ELEMS{1'b0}};
+            key_words <= {NUM_KEYS*BLOCK_ELEMS{1'b0}};
+            p_valid <= 1'b0;
+            p_last <= 1'b0;
+            c_valid <= 1'b0;
+            c_last <= 1'b0;
+            done <= 1'b0;
+        end
+        else begin
+            p_valid <= flush;
+            p_last <= flush && a_last;
+            c_valid <= p_valid;
+            c_last <= p_last;
+            done <= c_valid && c_last && !start;
+
+            if (start) begin
+                buf_elem <= {BLOCK_ELEMS*ELEM_WIDTH{1'b0}};
+                key_buf <= {NUM_KEYS*BLOCK_ELEMS{1'b0}};
+                fill <= 0;
+            end
+            else if (flush) begin
+                for (pi = 0; pi < ELEM_WIDTH; pi = pi + 1)
+                    for (pj = 0; pj < BLOCK_ELEMS; pj = pj + 1)
+                        planes[pi*BLOCK_ELEMS + pj] <= elem_next[pj*ELEM_WIDTH + pi];
+                key_words <= key_next;
+                buf_elem <= {BLOCK_ELEMS*ELEM_WIDTH{1'b0}};
+                key_buf <= {NUM_KEYS*BLOCK_ELEMS{1'b0}};
+                fill <= 0;
+            end
+            else if (a_valid) begin
+                buf_elem <= elem_next;
+                key_buf <= key_next;
+                fill <= fill_next[FILL_WIDTH-1:0];
+            end
+        end
+    end
+
+    genvar k;
+    generate
+        for (k = 0; k < NUM_KEYS; k = k + 1) begin : key_lane
+            // counts[b]: popcount(plane_b & key word)
+            reg [CNT_WIDTH-1:0] counts [0:ELEM_WIDTH-1];
+            integer pb, wb;
+            always @(posedge clk) begin
+                for (pb = 0; pb < ELEM_WIDTH; pb = pb + 1)
+                    counts[pb] <= popcount(planes[pb*BLOCK_ELEMS +: BLOCK_ELEMS] &
+                                           key_words[k*BLOCK_ELEMS +: BLOCK_ELEMS]);
+            end
+
+            // sum_b 2^b * counts[b]
+            reg [ACC_WIDTH-1:0] weighted;
+            always @(*) begin
+                weighted = {ACC_WIDTH{1'b0}};
+                for (wb = 0; wb < ELEM_WIDTH; wb = wb + 1)
+                    weighted = weighted + ({{ACC_WIDTH{1'b0}}, counts[wb]} << wb);
+            end
+
+            reg [ACC_WIDTH-1:0] accumulator;
+            reg [ACC_WIDTH-1:0] result;
+            always @(posedge clk or negedge rst_n) begin
+                if (!rst_n) begin
+                    accumulator <= {ACC_WIDTH{1'b0}};
+                    result <= {ACC_WIDTH{1'b0}};
+                end
+                else if (start) begin
+                    accumulator <= 0;
+                end
+                else if (c_valid && c_last) begin // result goes to dot_product, ready for the next vector
+                    result <= accumulator + weighted;
+                    accumulator <= 0;
+                end
+                else if (c_valid) begin
+                    accumulator <= accumulator + weighted;
+                end
+            end
+
+            assign dot_product[k*ACC_WIDTH +: ACC_WIDTH] = result;
+        end
+    endgenerate
+
+endmodule
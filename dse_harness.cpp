@@ -0,0 +1,111 @@
+// Verilator harness used by dse_sweep.py to measure cycles per PRF slot.
+//
+// Loads an 8-byte all-zero nonce, keeps the prf_evaluate request queue
+// full with index requests and prints the steady-state number of clock
+// cycles per slot (first done to last done) and the latency of the first
+// slot.
+//
+// Built by dse_sweep.py; by hand:
+//   verilator --cc --exe --build --top-module prf_evaluate -Wno-fatal
+//       <rtl sources> dse_harness.cpp
+//   ./obj_dir/Vprf_evaluate [slots]
+
+#include "Vprf_evaluate.h"
+#include "verilated.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+static const uint64_t SLOT_TIMEOUT = 1u << 20;
+
+static void tick(Vprf_evaluate& top, uint64_t& cycles) {
+    top.clk = 0;
+    top.eval();
+    top.clk = 1;
+    top.eval();
+    cycles++;
+}
+
+int main(int argc, char **argv) {
+    int slots = (argc > 1) ? atoi(argv[1]) : 16;
+    if (slots <= 0) {
+        fprintf(stderr, "Error: slot count must be positive\n");
+        return 1;
+    }
+
+    const std::unique_ptr<VerilatedContext> ctx{new VerilatedContext};
+    ctx->commandArgs(argc, argv);
+    Vprf_evaluate top{ctx.get()};
+
+    uint64_t cycles = 0;
+
+    // Reset
+    top.rst_n = 0;
+    top.start = 0;
+    top.nonce_valid = 0;
+    top.key_wr_en = 0;
+    top.key_swap = 0;
+    top.perf_wr_en = 0;
+    top.perf_rd_en = 0;
+    top.index = 0;
+    for (int i = 0; i < 4; i++)
+        tick(top, cycles);
+    top.rst_n = 1;
+    tick(top, cycles);
+
+    // Nonce: one full last beat, absorbed once for all slots
+    top.nonce_data = 0;
+    top.nonce_keep = 0xff;
+    top.nonce_last = 1;
+    top.nonce_valid = 1;
+    while (!top.nonce_ready)
+        tick(top, cycles);
+    tick(top, cycles);
+    top.nonce_valid = 0;
+
+    uint64_t begin = cycles;
+    uint64_t first_done = 0, last_done = 0, last_progress = cycles;
+    int pushed = 0, completed = 0;
+    while (completed < slots) {
+        // Push a request whenever the queue has room
+        top.index = (uint64_t)pushed;
+        top.start = (pushed < slots) && top.ready;
+        bool push = top.start;
+        tick(top, cycles);
+        top.start = 0;
+        if (push)
+            pushed++;
+
+        // done is registered: sample it after the edge
+        if (top.done) {
+            if ((int)top.prf_index != completed) {
+                fprintf(stderr, "Error: slot %d completed out of order (prf_index %llu)\n",
+                        completed, (unsigned long long)top.prf_index);
+                return 1;
+            }
+            if (completed == 0)
+                first_done = cycles;
+            last_done = cycles;
+            last_progress = cycles;
+            completed++;
+        }
+        else if (cycles - last_progress > SLOT_TIMEOUT) {
+            fprintf(stderr, "Error: slot %d did not finish within %llu cycles\n",
+                    completed, (unsigned long long)SLOT_TIMEOUT);
+            return 1;
+        }
+    }
+
+    double per_slot = (slots > 1) ? (double)(last_done - first_done) / (double)(slots - 1)
+                                  : (double)(first_done - begin);
+
+    printf("slots=%d\n", slots);
+    printf("latency=%llu\n", (unsigned long long)(first_done - begin));
+    printf("cycles_per_slot=%.2f\n", per_slot);
+    printf("prf_out=%u\n", (unsigned)top.prf_out);
+
+    top.final();
+    return 0;
+}
@@ -0,0 +1,256 @@
+"""
+Design-space exploration sweep over the prf_evaluate RTL parameters.
+
+For every point in the parameter grid this script:
+1. Builds prf_evaluate with Verilator (dse_harness.cpp) and measures cycles per slot
+2. Synthesizes prf_evaluate with Yosys for cell/flop counts and the longest
+   topological path (logic levels), used as a critical-path estimate
+3. Combines both into slots/s and prints the Pareto front of slots/s vs. area
+
+Usage:
+  python3 dse_sweep.py                              # default grid
+  python3 dse_sweep.py --param N_LWR=445,742 --param P=16,32
+  python3 dse_sweep.py --target xilinx --csv dse_results.csv
+
+Requires verilator and yosys on PATH. Build products go to dse_build/.
+"""
+
+import argparse
+import csv
+import itertools
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+# RTL sources for prf_evaluate (testbenches excluded)
+RTL_SOURCES = [
+    "keccak_round.v",
+    "keccak_f1600.v",
+    "shake256.v",
+    "hash_to_vector.v",
+    "secret_key.v",
+    "dot_product.v",
+    "dot_product_bitplane.v",
+    "prf_rounding.v",
+    "perf_counters.v",
+    "prf_evaluate.v",
+]
+
+TOP = "prf_evaluate"
+HARNESS = "dse_harness.cpp"
+
+# Parameters of prf_evaluate swept by default
+DEFAULT_GRID = {
+    "N_LWR": [445, 742],
+    "ROUNDS_PER_CYCLE": [1, 2, 4],
+    "ELEMS_PER_CYCLE": [1, 4],
+    "DOT_IMPL": [0, 1],
+}
+
+# Yosys synthesis command per target; the area metric is the cell count
+# (LUTs + flops on FPGA targets)
+SYNTH_COMMANDS = {
+    "generic": "synth -flatten -top {top}",
+    "ice40": "synth_ice40 -top {top}",
+    "xilinx": "synth_xilinx -flatten -top {top}",
+}
+
+
+def parse_grid(param_args):
+    """Turn ['NAME=v1,v2', ...] into {'NAME': [v1, v2]}, defaulting to DEFAULT_GRID."""
+    if not param_args:
+        return dict(DEFAULT_GRID)
+
+    grid = {}
+    for arg in param_args:
+        if "=" not in arg:
+            raise ValueError(f"--param expects NAME=v1,v2,... (got '{arg}')")
+        name, values = arg.split("=", 1)
+        grid[name.strip()] = [int(v, 0) for v in values.split(",") if v.strip()]
+    return grid
+
+
+def config_name(config):
+    return "_".join(f"{k}{v}" for k, v in config.items()) or "default"
+
+
+def run(cmd, cwd=None, log=None):
+    """Run a command, optionally teeing output to a log file. Returns stdout."""
+    result = subprocess.run(cmd, cwd=cwd, capture_output=True, text=True)
+    if log:
+        with open(log, "w") as f:
+            f.write(result.stdout)
+            f.write(result.stderr)
+    if result.returncode != 0:
+        raise RuntimeError(f"{cmd[0]} failed (see {log})" if log else result.stderr)
+    return result.stdout
+
+
+def measure_cycles(config, build_dir, slots, repo_dir):
+    """Verilate prf_evaluate with the given parameters and return cycles per slot."""
+    obj_dir = os.path.join(build_dir, "obj_dir")
+    cmd = [
+        "verilator", "--cc", "--exe", "--build", "-O3",
+        "-Wno-fatal", "--top-module", TOP,
+        "-Mdir", obj_dir,
+    ]
+    cmd += [f"-G{k}={v}" for k, v in config.items()]
+    cmd += [os.path.join(repo_dir, f) for f in RTL_SOURCES]
+    cmd += [os.path.join(repo_dir, HARNESS)]
+    run(cmd, log=os.path.join(build_dir, "verilator.log"))
+
+    # $readmemh/$readmemb paths are relative, so run from the repository
+    out = run([os.path.join(obj_dir, f"V{TOP}"), str(slots)], cwd=repo_dir,
+              log=os.path.join(build_dir, "sim.log"))
+    match = re.search(r"cycles_per_slot=([0-9.]+)", out)
+    if not match:
+        raise RuntimeError(f"no cycles_per_slot in harness output ({build_dir}/sim.log)")
+    return float(match.group(1))
+
+
+def synthesize(config, build_dir, target, repo_dir):
+    """Synthesize prf_evaluate with Yosys. Returns (cells, flops, logic_levels)."""
+    chparams = " ".join(f"-chparam {k} {v}" for k, v in config.items())
+    script = "; ".join([
+        "read_verilog -defer " + " ".join(os.path.join(repo_dir, f) for f in RTL_SOURCES),
+        f"hierarchy -top {TOP} {chparams}",
+        SYNTH_COMMANDS[target].format(top=TOP),
+        "stat",
+        "ltp -noff",
+    ])
+    out = run(["yosys", "-q", "-p", script, "-l", os.path.join(build_dir, "yosys.log")],
+              cwd=repo_dir)
+    with open(os.path.join(build_dir, "yosys.log")) as f:
+        out += f.read()
+
+    # Older Yosys prints "Number of cells: N", newer releases "N cells"
+    cells = re.findall(r"Number of cells:\s+(\d+)", out)
+    cells += re.findall(r"^\s+(\d+)\s+cells\s*$", out, re.MULTILINE)
+    if not cells:
+        raise RuntimeError(f"no cell count in Yosys output ({build_dir}/yosys.log)")
+
+    # Flops: every cell type that is a flip-flop ($_DFF_PN0_, SB_DFFR, FDRE, ...),
+    # listed as "name count" or "count name" depending on the Yosys version
+    cell_lines = re.findall(r"^\s+(\S+)\s+(\d+)\s*$", out, re.MULTILINE)
+    cell_lines += [(n, c) for c, n in re.findall(r"^\s+(\d+)\s+(\S+)\s*$", out, re.MULTILINE)]
+    flops = 0
+    for name, count in cell_lines:
+        if re.search(r"DFF|^FD[CPRS]E?$", name):
+            flops += int(count)
+
+    levels = re.findall(r"Longest topological path in \S+ \(length=(\d+)\)", out)
+    return int(cells[-1]), flops, int(levels[-1]) if levels else 0
+
+
+def pareto_front(results):
+    """Points not dominated on (higher slots/s, lower cells)."""
+    front = []
+    for r in results:
+        dominated = any(
+            o["slots_per_sec"] >= r["slots_per_sec"] and o["cells"] <= r["cells"]
+            and (o["slots_per_sec"] > r["slots_per_sec"] or o["cells"] < r["cells"])
+            for o in results
+        )
+        if not dominated:
+            front.append(r)
+    return sorted(front, key=lambda r: r["cells"])
+
+
+def print_table(rows, param_names, title):
+    print(title)
+    print("-" * 80)
+    header = param_names + ["cyc/slot", "cells", "flops", "levels", "Fmax MHz", "slots/s"]
+    print("  ".join(f"{h:>10}" for h in header))
+    for r in rows:
+        values = [str(r["config"][p]) for p in param_names]
+        values += [
+            f"{r['cycles_per_slot']:.1f}", str(r["cells"]), str(r["flops"]),
+            str(r["levels"]), f"{r['fmax_mhz']:.1f}", f"{r['slots_per_sec']:.0f}",
+        ]
+        print("  ".join(f"{v:>10}" for v in values))
+    print()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="prf_evaluate design-space sweep")
+    parser.add_argument("--param", action="append",
+                        help="NAME=v1,v2,... parameter values to sweep (repeatable)")
+    parser.add_argument("--slots", type=int, default=8,
+                        help="slots simulated per configuration")
+    parser.add_argument("--target", choices=sorted(SYNTH_COMMANDS), default="generic",
+                        help="Yosys synthesis flow")
+    parser.add_argument("--ns-per-level", type=float, default=0.5,
+                        help="delay per logic level for the Fmax estimate")
+    parser.add_argument("--build-dir", default="dse_build")
+    parser.add_argument("--csv", help="also write all results to this CSV file")
+    args = parser.parse_args()
+
+    for tool in ("verilator", "yosys"):
+        if shutil.which(tool) is None:
+            print(f"Error: {tool} not found on PATH")
+            return 1
+
+    repo_dir = os.path.dirname(os.path.abspath(__file__))
+    grid = parse_grid(args.param)
+    names = list(grid)
+
+    print("=" * 80)
+    print("LWR-PRF Design-Space Exploration")
+    print("=" * 80)
+    for name in names:
+        print(f"  {name}: {grid[name]}")
+    print()
+
+    results = []
+    for values in itertools.product(*(grid[n] for n in names)):
+        config = dict(zip(names, values))
+        build_dir = os.path.abspath(os.path.join(args.build_dir, config_name(config)))
+        os.makedirs(build_dir, exist_ok=True)
+        print(f"[{config_name(config)}] ", end="", flush=True)
+
+        try:
+            cycles = measure_cycles(config, build_dir, args.slots, repo_dir)
+            cells, flops, levels = synthesize(config, build_dir, args.target, repo_dir)
+        except RuntimeError as e:
+            print(f"✗ {e}")
+            continue
+
+        fmax = 1000.0 / (max(levels, 1) * args.ns_per_level)
+        slots_per_sec = fmax * 1e6 / cycles
+        results.append({
+            "config": config,
+            "cycles_per_slot": cycles,
+            "cells": cells,
+            "flops": flops,
+            "levels": levels,
+            "fmax_mhz": fmax,
+            "slots_per_sec": slots_per_sec,
+        })
+        print(f"✓ {cycles:.1f} cycles/slot, {cells} cells, {levels} levels")
+
+    if not results:
+        print("No configuration completed")
+        return 1
+
+    print()
+    print_table(sorted(results, key=lambda r: r["cells"]), names, "All configurations")
+    print_table(pareto_front(results), names, "Pareto front (slots/s vs. cells)")
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.writer(f)
+            writer.writerow(names + ["cycles_per_slot", "cells", "flops", "levels",
+                                     "fmax_mhz", "slots_per_sec"])
+            for r in results:
+                writer.writerow([r["config"][n] for n in names] + [
+                    r["cycles_per_slot"], r["cells"], r["flops"], r["levels"],
+                    f"{r['fmax_mhz']:.2f}", f"{r['slots_per_sec']:.0f}"])
+        print(f"✓ Results written to {args.csv}")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -6,9 +6,10 @@ module encrypt #(
     output wire [$clog2(P)-1:0] ciphertext
 );
     localparam WIDTH = $clog2(P);
+    localparam POW2 = (P == (1 << WIDTH)); // mod P is the low WIDTH bits
 
     wire [WIDTH:0] sum; // one extra bit for overflow
     assign sum = plaintext + prf_out;
-    assign ciphertext = (sum >= P) ? (sum - P) : sum[WIDTH-1:0];
+    assign ciphertext = (!POW2 && sum >= P) ? (sum - P) : sum[WIDTH-1:0];
 
-endmodule
\ No newline at end of file
+endmodule
@@ -1,7 +1,7 @@
 // Generates reference test vectors for keccak_f1600 Verilog testbench.
 //
-// Outputs f1600_vectors.hex: 50 lines of 64-bit hex values
-// (2 test cases x 25 lanes per state).
+// Outputs f1600_vectors.hex: 100 lines of 64-bit hex values
+// (4 test cases x 25 lanes per state).
 //
 // Compile and run:
 //   g++ -o gen_f1600_vectors gen_f1600_vectors.cpp && ./gen_f1600_vectors
@@ -102,7 +102,16 @@ int main() {
     keccak_f1600(state);
     write_state(f, state, "\nTest 2: keccak_f1600(lane0=DEADBEEFCAFEBABE)");
 
+    // Tests 3-4: chained permutations of the all-zero state
+    memset(state, 0, sizeof(state));
+    keccak_f1600(state);
+    keccak_f1600(state);
+    write_state(f, state, "\nTest 3: keccak_f1600^2(all-zeros)");
+
+    keccak_f1600(state);
+    write_state(f, state, "\nTest 4: keccak_f1600^3(all-zeros)");
+
     fclose(f);
-    fprintf(stderr, "\nWrote f1600_vectors.hex (50 lines)\n");
+    fprintf(stderr, "\nWrote f1600_vectors.hex (100 lines)\n");
     return 0;
 }
@@ -52,7 +52,19 @@ int main() {
     auto d4 = h.digest(256);
     output_lanes(f, d4, "\nTest 4: SHAKE256('', 256)");
 
+    // Test 5: SHAKE256(136 * 0xa3, 32) — message fills the rate exactly
+    h.reset();
+    h.update(a3, 136);
+    auto d5 = h.digest(32);
+    output_lanes(f, d5, "\nTest 5: SHAKE256(136*0xa3, 32)");
+
+    // Test 6: SHAKE256(141 * 0xa3, 32) — partial lane in the second block
+    h.reset();
+    h.update(a3, 141);
+    auto d6 = h.digest(32);
+    output_lanes(f, d6, "\nTest 6: SHAKE256(141*0xa3, 32)");
+
     fclose(f);
-    fprintf(stderr, "\nWrote shake256_vectors.hex (44 lines)\n");
+    fprintf(stderr, "\nWrote shake256_vectors.hex (52 lines)\n");
     return 0;
 }
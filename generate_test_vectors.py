@@ -4,9 +4,11 @@ Generate test vectors for Verilog hardware verification.
 This script:
 1. Loads the LWR-PRF client with the same parameters as hardware
 2. Generates a hash vector for a test nonce and index
-3. Saves hash_vector.mem for the hash stub module
+3. Saves hash_vector.mem, the element stream expected from hash_to_vector
 4. Saves secret_key.mem for the secret key module
 5. Computes and prints expected intermediate values for verification
+6. Prints expected PRF outputs for the other nonces in prf_evaluate_tb.v
+   and the keystream checked by prf_keystream_tb.v
 """
 
 import sys
@@ -42,12 +44,12 @@ def main():
     prf = LWR_PRF_Client(n=n, N=N, p=p, seed=42, force_regenerate=False)
     print()
 
-    # Test case: Use a simple nonce
-    nonce = b"test_nonce"
+    # Test case: Use a simple nonce (one 8-byte beat of the RTL nonce stream)
+    nonce = b"lwr_seed"
     index = 0
 
     print(f"Test Case:")
-    print(f"  Nonce: {nonce}")
+    print(f"  Nonce: {nonce} (port value 0x{int.from_bytes(nonce, 'little'):016x})")
     print(f"  Index: {index}")
     print()
 
@@ -156,6 +158,23 @@ def main():
         print(f"✗ ERROR: Round-trip failed!")
     print()
 
+    # =========================================================================
+    # Other nonce lengths (prf_evaluate_tb.v test cases 5-7)
+    # =========================================================================
+    print("Expected PRF outputs for other nonce lengths...")
+    print("-" * 80)
+    for label, other in [("some_seed", b"some_seed"),
+                         ("bytes 0..127", bytes(range(128))),
+                         ("bytes 0..129", bytes(range(130))),
+                         ("bytes 0..139", bytes(range(140)))]:
+        outputs = [int(v) for v in prf.evaluate_multiple(other, 2)]
+        print(f"  {label:<14} ({len(other):3d} bytes): slot 0 -> {outputs[0]}, slot 1 -> {outputs[1]}")
+    print()
+
+    keystream = [int(v) for v in prf.evaluate_multiple(nonce, 6)]
+    print(f"Keystream for {nonce}, slots 0-5 (prf_keystream_tb.v): {keystream}")
+    print()
+
     # =========================================================================
     # Summary for Verilog testbench
     # =========================================================================
@@ -177,7 +196,7 @@ def main():
     print()
 
     print("Files generated:")
-    print("  ✓ hash_vector.mem  - Hash vector for hash_to_vector module")
+    print("  ✓ hash_vector.mem  - Expected hash_to_vector element stream")
     print("  ✓ secret_key.mem   - Binary secret key for secret_key module")
     print()
     print("Next step: Run Verilog simulation and compare outputs!")
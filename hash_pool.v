@@ -0,0 +1,202 @@
+// ENGINES hash_to_vector engines (one shake256 each) shared by CONSUMERS
+// request ports, so hashing capacity is sized apart from the number of
+// dot product back-ends.
+//
+// A consumer raises req_valid with req_index; each cycle the first
+// waiting consumer at or after the last one served (rotating priority) is
+// given the lowest ready engine, and req_ready is high for it in that
+// cycle. The engine is tagged with its consumer and its element stream
+// (hash_* as in hash_to_vector) is routed to that consumer's lanes of the
+// hash_* outputs. A consumer has one request outstanding at a time; its
+// next request is taken once its current vector has ended with hash_last.
+//
+// The nonce goes to every engine; nonce_ready is high only when all of
+// them can take the beat.
+//
+// A perf_counter_bank counts each engine's hash_to_vector perf_events
+// (counter register 1 + e for event e); perf_engine selects the engine
+// the perf_* register access goes to.
+module hash_pool #(
+    parameter N_LWR = 445,
+    parameter N = 2048,
+    parameter ELEM_WIDTH = 12,
+    parameter ROUNDS_PER_CYCLE = 1,
+    parameter ELEMS_PER_CYCLE = 1, // 1-17
+    parameter ENGINES = 2,
+    parameter CONSUMERS = 4
+) (
+    input wire clk,
+    input wire rst_n,
+
+    input wire [63:0] nonce_data,
+    input wire [7:0] nonce_keep,
+    input wire nonce_valid,
+    input wire nonce_last,
+    output wire nonce_ready,
+
+    // Requests, consumer c in bit c / index bits [c*64 +: 64]
+    input wire [CONSUMERS-1:0] req_valid,
+    input wire [CONSUMERS*64-1:0] req_index,
+    output wire [CONSUMERS-1:0] req_ready,
+
+    // Element streams, consumer c in lane c of each output
+    output reg [CONSUMERS*ELEMS_PER_CYCLE*ELEM_WIDTH-1:0] hash_out,
+    output reg [CONSUMERS*$clog2(N_LWR)-1:0] hash_idx,
+    output reg [CONSUMERS*ELEMS_PER_CYCLE-1:0] hash_mask,
+    output reg [CONSUMERS-1:0] hash_valid,
+    output reg [CONSUMERS-1:0] hash_last,
+
+    // Performance counters of engine perf_engine
+    input wire [((ENGINES > 1) ? $clog2(ENGINES) : 1)-1:0] perf_engine,
+    input wire [4:0] perf_addr,
+    input wire perf_wr_en,
+    input wire [31:0] perf_wr_data,
+    input wire perf_rd_en,
+    output wire [31:0] perf_rd_data,
+    output wire perf_rd_valid
+);
+
+    localparam IDX_WIDTH = $clog2(N_LWR);
+    localparam BEAT_WIDTH = ELEMS_PER_CYCLE * ELEM_WIDTH;
+    localparam CPTR_WIDTH = (CONSUMERS > 1) ? $clog2(CONSUMERS) : 1;
+    localparam EPTR_WIDTH = (ENGINES > 1) ? $clog2(ENGINES) : 1;
+
+    // Per-engine signals, packed by engine
+    wire [ENGINES-1:0] eng_ready;
+    wire [ENGINES-1:0] eng_nonce_ready;
+    wire [ENGINES*BEAT_WIDTH-1:0] eng_out;
+    wire [ENGINES*IDX_WIDTH-1:0] eng_idx;
+    wire [ENGINES*ELEMS_PER_CYCLE-1:0] eng_mask;
+    wire [ENGINES-1:0] eng_valid;
+    wire [ENGINES-1:0] eng_last;
+    wire [ENGINES*6-1:0] eng_perf;
+
+    reg [CPTR_WIDTH-1:0] owner [0:ENGINES-1]; // consumer tag of each engine
+    reg [CONSUMERS-1:0] busy;                 // consumer has a vector in flight
+    reg [CPTR_WIDTH-1:0] rr;
+
+    // Arbiter: first waiting consumer at or after rr, lowest ready engine
+    reg [CPTR_WIDTH-1:0] sel_c;
+    reg sel_c_valid;
+    reg [EPTR_WIDTH-1:0] sel_e;
+    reg sel_e_valid;
+    integer c, cc, e;
+    always @(*) begin
+        sel_c = rr;
+        sel_c_valid = 1'b0;
+        for (c = CONSUMERS - 1; c >= 0; c = c - 1) begin
+            cc = (rr + c) % CONSUMERS;
+            if (req_valid[cc] && !busy[cc]) begin
+                sel_c = cc;
+                sel_c_valid = 1'b1;
+            end
+        end
+        sel_e = 0;
+        sel_e_valid = 1'b0;
+        for (e = ENGINES - 1; e >= 0; e = e - 1) begin
+            if (eng_ready[e]) begin
+                sel_e = e;
+                sel_e_valid = 1'b1;
+            end
+        end
+    end
+
+    wire grant = sel_c_valid && sel_e_valid;
+    wire [CONSUMERS-1:0] sel_onehot = 1 << sel_c;
+    assign req_ready = grant ? sel_onehot : {CONSUMERS{1'b0}};
+
+    // Route each engine's beat to its consumer's lane
+    integer re, rc;
+    always @(*) begin
+        hash_out = {CONSUMERS*BEAT_WIDTH{1'b0}};
+        hash_idx = {CONSUMERS*IDX_WIDTH{1'b0}};
+        hash_mask = {CONSUMERS*ELEMS_PER_CYCLE{1'b0}};
+        hash_valid = {CONSUMERS{1'b0}};
+        hash_last = {CONSUMERS{1'b0}};
+        for (re = 0; re < ENGINES; re = re + 1) begin
+            if (eng_valid[re]) begin
+                rc = owner[re];
+                hash_out[rc*BEAT_WIDTH +: BEAT_WIDTH] = eng_out[re*BEAT_WIDTH +: BEAT_WIDTH];
+                hash_idx[rc*IDX_WIDTH +: IDX_WIDTH] = eng_idx[re*IDX_WIDTH +: IDX_WIDTH];
+                hash_mask[rc*ELEMS_PER_CYCLE +: ELEMS_PER_CYCLE] = eng_mask[re*ELEMS_PER_CYCLE +: ELEMS_PER_CYCLE];
+                hash_valid[rc] = 1'b1;
+                hash_last[rc] = eng_last[re];
+            end
+        end
+    end
+
+    integer i;
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            busy <= {CONSUMERS{1'b0}};
+            rr <= 0;
+            for (i = 0; i < ENGINES; i = i + 1)
+                owner[i] <= 0;
+        end
+        else begin
+            for (i = 0; i < CONSUMERS; i = i + 1)
+                if (hash_valid[i] && hash_last[i])
+                    busy[i] <= 1'b0;
+
+            if (grant) begin
+                owner[sel_e] <= sel_c;
+                busy[sel_c] <= 1'b1;
+                rr <= (sel_c == CONSUMERS - 1) ? 0 : sel_c + 1'd1;
+            end
+        end
+    end
+
+    wire all_nonce_ready = &eng_nonce_ready;
+
+    genvar g;
+    generate
+        for (g = 0; g < ENGINES; g = g + 1) begin : engine
+            hash_to_vector #(
+                .N_LWR(N_LWR),
+                .N(N),
+                .ELEM_WIDTH(ELEM_WIDTH),
+                .ROUNDS_PER_CYCLE(ROUNDS_PER_CYCLE),
+                .ELEMS_PER_CYCLE(ELEMS_PER_CYCLE)
+            ) hash (
+                .clk(clk),
+                .rst_n(rst_n),
+                .nonce_data(nonce_data),
+                .nonce_keep(nonce_keep),
+                .nonce_valid(nonce_valid && all_nonce_ready),
+                .nonce_last(nonce_last),
+                .nonce_ready(eng_nonce_ready[g]),
+                .nonce_loaded(),
+                .start(grant && (sel_e == g)),
+                .ready(eng_ready[g]),
+                .index(req_index[sel_c*64 +: 64]),
+                .hash_out(eng_out[g*BEAT_WIDTH +: BEAT_WIDTH]),
+                .hash_idx(eng_idx[g*IDX_WIDTH +: IDX_WIDTH]),
+                .hash_mask(eng_mask[g*ELEMS_PER_CYCLE +: ELEMS_PER_CYCLE]),
+                .hash_valid(eng_valid[g]),
+                .hash_last(eng_last[g]),
+                .done(),
+                .perf_events(eng_perf[g*6 +: 6])
+            );
+        end
+    endgenerate
+
+    assign nonce_ready = all_nonce_ready;
+
+    perf_counter_bank #(
+        .NUM_EVENTS(6),
+        .ADDR_WIDTH(5),
+        .INSTANCES(ENGINES)
+    ) perf (
+        .clk(clk),
+        .rst_n(rst_n),
+        .events(eng_perf),
+        .csr_sel(perf_engine),
+        .csr_addr(perf_addr),
+        .csr_wr_en(perf_wr_en),
+        .csr_wr_data(perf_wr_data),
+        .csr_rd_en(perf_rd_en),
+        .csr_rd_data(perf_rd_data),
+        .csr_rd_valid(perf_rd_valid)
+    );
+
+endmodule
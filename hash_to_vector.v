@@ -1,85 +1,298 @@
-// UPDATE TO USE SHAKE-256 - CURRENTLY A TEMPLATE THAT READS PLACEHOLDER VALUES
+// H(nonce, index): SHAKE256(nonce || index_le64) squeezed as n 64-bit
+// lanes, element i = lane i mod 2N (the low ELEM_WIDTH bits). Matches
+// LWR_PRF_Client.hash_to_vector for any nonce length.
+//
+// The nonce arrives once per message as a byte stream (8 bytes a beat,
+// first byte in [7:0]; every beat but the last is full). Its complete rate
+// blocks are absorbed as they fill and kept as a midstate, the remaining
+// tail bytes are kept as a padded template block. start (index) is taken
+// while ready is high, i.e. once the nonce is loaded; a new nonce message
+// may begin whenever nonce_ready is high and replaces the old one.
+//
+// nonce_loaded is high from the last beat of a message until the first
+// beat of the next. A wrapper that queues requests in front of this core
+// must hold them off until then, and must not pass on a nonce beat in the
+// cycle it takes a request: a request stuck waiting for the nonce while
+// holding off the nonce's beats never completes.
+//
+// Each beat carries up to ELEMS_PER_CYCLE elements: element hash_idx + i in
+// hash_out[i*ELEM_WIDTH +: ELEM_WIDTH] when hash_mask[i] is set. Beats are
+// clipped at the end of a rate block and at element N_LWR-1; set mask bits
+// are always contiguous from bit 0.
 module hash_to_vector #(
     parameter N_LWR = 445,
     parameter N = 2048,
-    parameter ELEM_WIDTH = 12
+    parameter ELEM_WIDTH = 12,
+    parameter ROUNDS_PER_CYCLE = 1,
+    parameter ELEMS_PER_CYCLE = 1  // 1-17
 ) (
     input wire clk,
     input wire rst_n,
+
+    input wire [63:0] nonce_data,
+    input wire [7:0] nonce_keep,  // contiguous from byte 0
+    input wire nonce_valid,
+    input wire nonce_last,
+    output wire nonce_ready,
+    output wire nonce_loaded,     // a complete nonce message is loaded
+
     input wire start,
-    input wire [63:0] nonce,      // Not used in stub version
-    input wire [63:0] index,      // Not used in stub version
+    output wire ready,
+    input wire [63:0] index,
 
-    output reg [ELEM_WIDTH-1:0] hash_out,
+    output reg [ELEMS_PER_CYCLE*ELEM_WIDTH-1:0] hash_out,
     output reg [$clog2(N_LWR)-1:0] hash_idx,
+    output reg [ELEMS_PER_CYCLE-1:0] hash_mask,
     output reg hash_valid,
     output reg hash_last,
-    output reg done
+    output reg done,
+
+    // [4:0] shake256 perf_events, [5] busy (a nonce block or slot in progress)
+    output wire [5:0] perf_events
 );
 
-    // Memory to store pre-computed hash values from Python
-    reg [ELEM_WIDTH-1:0] hash_mem [0:N_LWR-1];
+    // State machine
+    localparam IDLE = 4'd0;
+    localparam NONCE_LOAD = 4'd1;   // load a full nonce block (midstate ^ tail)
+    localparam NONCE_WAIT = 4'd2;   // wait for its permutation, keep the midstate
+    localparam NONCE_FINISH = 4'd3; // build the template from the tail
+    localparam LOAD = 4'd4;         // wait for shake256 to be free, load the slot
+    localparam STRADDLE = 4'd5;     // absorb the index bytes past the block end
+    localparam STREAMING = 4'd6;
+    localparam DONE_STATE = 4'd7;
+    localparam IDX_WIDTH = $clog2(N_LWR);
+    localparam RATE_BITS = 1088;
+
+    reg [3:0] state;
+    reg [63:0] index_reg;
+    reg [IDX_WIDTH-1:0] counter; // index of the first element of the beat
+    reg [4:0] block_lane;        // lane of the beat within the rate block
+    reg sh_used; // shake256 has left S_IDLE at least once
+
+    // Nonce: midstate after its complete rate blocks, tail bytes of the
+    // open block and their count (the byte offset of the index)
+    reg [1599:0] midstate;
+    reg [RATE_BITS-1:0] tail;
+    reg [7:0] tail_len;
+    reg tail_last;   // the full block in NONCE_LOAD ends the nonce
+    reg nonce_done;  // template_state holds the loaded nonce
 
-    // Load hash vector from file (generated by Python script)
-    initial begin
-        $readmemh("hash_vector.mem", hash_mem);
+    // A new message starts from an empty sponge
+    wire [RATE_BITS-1:0] cur_tail = nonce_done ? {RATE_BITS{1'b0}} : tail;
+    wire [7:0] cur_len = nonce_done ? 8'd0 : tail_len;
+
+    reg [63:0] beat_data;
+    reg [3:0] beat_bytes;
+    integer bi;
+    always @(*) begin
+        beat_bytes = 4'd0;
+        for (bi = 0; bi < 8; bi = bi + 1) begin
+            beat_data[bi*8 +: 8] = nonce_keep[bi] ? nonce_data[bi*8 +: 8] : 8'h00;
+            if (nonce_keep[bi])
+                beat_bytes = beat_bytes + 1'd1;
+        end
     end
 
-    // Counter to iterate through hash values
-    reg [$clog2(N_LWR)-1:0] counter;
+    wire [RATE_BITS-1:0] tail_next = cur_tail | ({{(RATE_BITS-64){1'b0}}, beat_data} << {cur_len, 3'b000});
+    wire [8:0] len_next = cur_len + beat_bytes;
 
-    // State machine
-    localparam IDLE = 2'b00;
-    localparam STREAMING = 2'b01;
-    localparam DONE_STATE = 2'b10;
+    // Counter mode: only the index bytes change between slots. The template
+    // is midstate ^ tail with the pad (0x1F after the index, 0x80 at byte
+    // 135) when the index fits the block; each slot XORs its index in at
+    // byte tail_len and loads the block with load_final, skipping the
+    // absorb beat and the pad cycle. An index that runs past byte 135
+    // (tail_len >= 128) loads the block as a midstate and absorbs the rest
+    // as a short last beat, letting shake256 pad.
+    wire straddle = (tail_len >= 8'd128);
+    wire [7:0] pad_pos = tail_len + 8'd8;
+    wire [RATE_BITS-1:0] pad_block = straddle ? {RATE_BITS{1'b0}} :
+        (({{(RATE_BITS-8){1'b0}}, 8'h1F} << {pad_pos, 3'b000}) ^ {8'h80, {(RATE_BITS-8){1'b0}}});
+
+    reg [1599:0] template_state;
+    wire [RATE_BITS-1:0] index_block = {{(RATE_BITS-64){1'b0}}, index_reg} << {tail_len, 3'b000};
+    wire [1599:0] slot_state = template_state ^ {{(1600-RATE_BITS){1'b0}}, index_block};
+
+    // Index bytes left over past the block end: 136 - tail_len went in
+    wire [7:0] rem_bytes = tail_len - 8'd128;
+    wire [63:0] rem_data = index_reg >> {8'd136 - tail_len, 3'b000};
+    wire [7:0] rem_keep = ~(8'hFF << rem_bytes[3:0]);
 
-    reg [1:0] state;
+    // SHAKE256
+    wire sh_free;
+    wire sh_load = ((state == LOAD) || (state == NONCE_LOAD)) && sh_free;
+    wire [1599:0] sh_load_state = (state == NONCE_LOAD) ?
+        (midstate ^ {{(1600-RATE_BITS){1'b0}}, tail}) : slot_state;
+    wire sh_in_ready;
+    wire [1599:0] sh_state;
+    wire [64*ELEMS_PER_CYCLE-1:0] sh_out;
+    wire sh_out_valid;
+    wire sh_done;
+    wire [4:0] sh_perf;
+
+    // Elements in this beat: shake256 clips beats at the end of the 17-lane
+    // rate block, this clips at element N_LWR-1. Tracked here rather than
+    // taken from data_out_keep, which depends on stop in stream mode.
+    wire [4:0] block_left = 5'd17 - block_lane;
+    reg [ELEMS_PER_CYCLE-1:0] beat_mask;
+    reg [ELEM_WIDTH*ELEMS_PER_CYCLE-1:0] beat_elems;
+    reg [5:0] beat_count;
+    integer ei;
+    always @(*) begin
+        beat_count = 6'd0;
+        for (ei = 0; ei < ELEMS_PER_CYCLE; ei = ei + 1) begin
+            beat_mask[ei] = (ei < block_left) && (counter + ei < N_LWR);
+            beat_elems[ei*ELEM_WIDTH +: ELEM_WIDTH] = sh_out[ei*64 +: ELEM_WIDTH];
+            if (beat_mask[ei])
+                beat_count = beat_count + 1'd1;
+        end
+    end
+
+    wire [IDX_WIDTH:0] next_counter = counter + beat_count;
+    wire last_elem = (next_counter >= N_LWR);
+
+    // N_LWR * 8 bytes are squeezed with out_len when they fit its 13 bits;
+    // larger vectors use stream mode, stopped on the beat holding element
+    // N_LWR-1 (this leaves one permutation in flight, which the next load
+    // waits for)
+    localparam USE_STREAM = (N_LWR * 8 > 8191);
+    localparam [12:0] OUT_BYTES = USE_STREAM ? 0 : N_LWR * 8;
+
+    shake256 #(
+        .ROUNDS_PER_CYCLE(ROUNDS_PER_CYCLE),
+        .ABSORB_LANES(1),
+        .SQUEEZE_LANES(ELEMS_PER_CYCLE)
+    ) shake (
+        .clk            (clk),
+        .rst_n          (rst_n),
+        .start          (1'b0), // every message is loaded
+        .data_in        (rem_data),
+        .data_in_keep   (rem_keep),
+        .data_in_valid  (state == STRADDLE),
+        .data_in_ready  (sh_in_ready),
+        .data_in_last   (1'b1),
+        .load_state     (sh_load_state),
+        .load_valid     (sh_load),
+        .load_final     ((state == LOAD) && !straddle),
+        .state_out      (sh_state),
+        .out_len        (OUT_BYTES),
+        .stream         (USE_STREAM != 0),
+        .stop           ((state == STREAMING) && last_elem),
+        .data_out       (sh_out),
+        .data_out_keep  (),
+        .data_out_valid (sh_out_valid),
+        .data_out_ready (state == STREAMING),
+        .data_out_last  (),
+        .done           (sh_done),
+        .perf_events    (sh_perf)
+    );
+
+    // A stopped stream may still be finishing a permutation; shake256
+    // raises done once it can take the next load. After a nonce block it
+    // waits in absorb, where a load is taken as well.
+    assign sh_free = !sh_used || sh_done || sh_in_ready;
+
+    wire idle = (state == IDLE) || (state == DONE_STATE);
+    assign ready = idle && nonce_done;
+    assign nonce_ready = idle && !(start && ready);
+    assign nonce_loaded = nonce_done;
+    assign perf_events = {!idle, sh_perf};
 
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             state <= IDLE;
+            index_reg <= 64'd0;
+            midstate <= 1600'd0;
+            tail <= {RATE_BITS{1'b0}};
+            tail_len <= 8'd0;
+            tail_last <= 1'b0;
+            nonce_done <= 1'b0;
+            template_state <= 1600'd0;
             counter <= 0;
+            block_lane <= 5'd0;
+            sh_used <= 1'b0;
             hash_out <= 0;
             hash_idx <= 0;
+            hash_mask <= 0;
             hash_valid <= 0;
             hash_last <= 0;
             done <= 0;
         end else begin
-            case (state)
-                IDLE: begin
-                    hash_valid <= 0;
-                    hash_last <= 0;
-                    done <= 0;
+            hash_valid <= 0;
+            hash_last <= 0;
 
-                    if (start) begin
+            case (state)
+                IDLE, DONE_STATE: begin
+                    if (start && ready) begin
+                        index_reg <= index;
                         counter <= 0;
-                        state <= STREAMING;
+                        block_lane <= 5'd0;
+                        done <= 0;
+                        state <= LOAD;
+                    end
+                    else if (nonce_valid) begin
+                        if (nonce_done)
+                            midstate <= 1600'd0;
+                        nonce_done <= 1'b0;
+                        tail <= tail_next;
+                        tail_len <= len_next[7:0];
+                        tail_last <= nonce_last;
+                        if (len_next == 9'd136)
+                            state <= NONCE_LOAD;
+                        else if (nonce_last)
+                            state <= NONCE_FINISH;
                     end
                 end
 
-                STREAMING: begin
-                    // Output current hash value
-                    hash_out <= hash_mem[counter];
-                    hash_idx <= counter;
-                    hash_valid <= 1;
-                    hash_last <= (counter == N_LWR - 1);
-
-                    if (counter == N_LWR - 1) begin
-                        state <= DONE_STATE;
-                        done <= 1;
-                    end else begin
-                        counter <= counter + 1;
+                NONCE_LOAD: begin
+                    if (sh_free) begin
+                        sh_used <= 1'b1;
+                        state <= NONCE_WAIT;
                     end
                 end
 
-                DONE_STATE: begin
-                    hash_valid <= 0;
-                    hash_last <= 0;
-                    // Stay in done state until reset or new start
-                    if (start) begin
-                        counter <= 0;
-                        done <= 0;
+                NONCE_WAIT: begin
+                    if (sh_in_ready) begin
+                        midstate <= sh_state;
+                        tail <= {RATE_BITS{1'b0}};
+                        tail_len <= 8'd0;
+                        state <= tail_last ? NONCE_FINISH : IDLE;
+                    end
+                end
+
+                NONCE_FINISH: begin
+                    template_state <= midstate ^ {{(1600-RATE_BITS){1'b0}}, tail ^ pad_block};
+                    nonce_done <= 1'b1;
+                    state <= IDLE;
+                end
+
+                LOAD: begin
+                    if (sh_free) begin
+                        sh_used <= 1'b1;
+                        state <= straddle ? STRADDLE : STREAMING;
+                    end
+                end
+
+                STRADDLE: begin
+                    if (sh_in_ready)
                         state <= STREAMING;
+                end
+
+                STREAMING: begin
+                    // Output each lane mod 2N as soon as it is squeezed
+                    if (sh_out_valid) begin
+                        hash_out <= beat_elems;
+                        hash_idx <= counter;
+                        hash_mask <= beat_mask;
+                        hash_valid <= 1;
+                        hash_last <= last_elem;
+
+                        if (last_elem) begin
+                            state <= DONE_STATE;
+                            done <= 1;
+                        end else begin
+                            counter <= next_counter[IDX_WIDTH-1:0];
+                            block_lane <= (beat_count == block_left) ? 5'd0 : block_lane + beat_count;
+                        end
                     end
                 end
 
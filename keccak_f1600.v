@@ -1,30 +1,60 @@
-module keccak_f1600 (
+module keccak_f1600 #(
+    parameter ROUNDS_PER_CYCLE = 1 // 1, 2, 3, 4, 6, 8, 12 or 24
+) (
     input  wire clk,
     input  wire rst_n,
     input  wire start,
+    input  wire chain,         // permute the previous output instead of state_in
     input  wire [1599:0] state_in,
     output wire [1599:0] state_out,
     output wire ready,
-    output wire done
+    output wire done           // permutation complete, core back in IDLE
 );
 
     // FSM states
     localparam IDLE = 1'b0;
     localparam RUNNING = 1'b1;
 
+    localparam [4:0] ROUND_STEP = ROUNDS_PER_CYCLE;
+    // Index of the first round applied in the final cycle
+    localparam [4:0] LAST_ROUND = 5'd24 - ROUND_STEP;
+
     reg fsm_state;
-    reg [4:0] round_counter;
+    reg [4:0] round_counter; // index of the first round applied this cycle
     reg [1599:0] state_reg;
 
-    // Round wires
+    // Round wires: round_chain[i] feeds round round_counter + i
+    wire [1599:0] round_chain [0:ROUNDS_PER_CYCLE];
     wire [1599:0] round_out;
 
-    // Single round
-    keccak_round k_round (
-        .state_in (state_reg),
-        .round (round_counter),
-        .state_out (round_out)
-    );
+    assign round_chain[0] = state_reg;
+    assign round_out = round_chain[ROUNDS_PER_CYCLE];
+
+    // ROUNDS_PER_CYCLE rounds chained combinationally
+    genvar ri;
+    generate
+        if (24 % ROUNDS_PER_CYCLE != 0) begin : bad_rounds_per_cycle
+            initial begin
+                $display("ERROR: keccak_f1600 ROUNDS_PER_CYCLE=%0d does not divide 24", ROUNDS_PER_CYCLE);
+                $finish;
+            end
+        end
+
+        for (ri = 0; ri < ROUNDS_PER_CYCLE; ri = ri + 1) begin : rounds
+            localparam [4:0] OFFSET = ri;
+
+            keccak_round k_round (
+                .state_in (round_chain[ri]),
+                .round (round_counter + OFFSET),
+                .state_out (round_chain[ri + 1])
+            );
+        end
+    endgenerate
+
+    // Chaining: start with chain in IDLE runs the first step on state_reg
+    // directly (no load cycle), permuting the previous output in place
+    wire resume = (fsm_state == IDLE) && start && chain;
+    wire last_step = ((fsm_state == RUNNING) || resume) && (round_counter == LAST_ROUND);
 
     // FSM and datapath
     always @(posedge clk or negedge rst_n) begin
@@ -36,7 +66,15 @@ module keccak_f1600 (
         else begin
             case (fsm_state)
                 IDLE: begin
-                    if (start) begin
+                    if (resume) begin
+                        state_reg <= round_out;
+
+                        if (!last_step) begin
+                            fsm_state <= RUNNING;
+                            round_counter <= ROUND_STEP;
+                        end
+                    end
+                    else if (start) begin
                         fsm_state <= RUNNING;
                         round_counter <= 5'd0;
                         state_reg <= state_in;
@@ -45,11 +83,14 @@ module keccak_f1600 (
 
                 RUNNING: begin
                     state_reg <= round_out;
-                    round_counter <= round_counter + 1'd1;
 
-                    if (round_counter == 5'd23) begin
+                    if (last_step) begin
+                        round_counter <= 5'd0;
                         fsm_state <= IDLE;
                     end
+                    else begin
+                        round_counter <= round_counter + ROUND_STEP;
+                    end
                 end
             endcase
         end
@@ -61,7 +102,7 @@ module keccak_f1600 (
         if (!rst_n)
             done_r <= 1'b0;
         else
-            done_r <= (fsm_state == RUNNING) && (round_counter == 5'd23);
+            done_r <= last_step;
     end
 
     // Outputs
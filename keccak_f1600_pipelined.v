@@ -0,0 +1,82 @@
+// Fully pipelined Keccak-f[1600]: one keccak_round per stage with the round
+// index fixed per stage. Accepts a new state every cycle and delivers it 24
+// cycles later with its tag. The whole pipeline stalls while the output
+// stage holds a result that is not accepted (out_ready low).
+module keccak_f1600_pipelined #(
+    parameter TAG_WIDTH = 8
+) (
+    input  wire clk,
+    input  wire rst_n,
+
+    // Input
+    input  wire [1599:0] in_state,
+    input  wire [TAG_WIDTH-1:0] in_tag,
+    input  wire in_valid,
+    output wire in_ready,
+
+    // Output
+    output wire [1599:0] out_state,
+    output wire [TAG_WIDTH-1:0] out_tag,
+    output wire out_valid,
+    input  wire out_ready
+);
+
+    localparam STAGES = 24;
+
+    // Stage outputs, stage s holds the state after round s. Each stage
+    // owns its registers (stage[s].*_r); these vectors only gather them.
+    wire [STAGES*1600-1:0] pipe_state;
+    wire [STAGES*TAG_WIDTH-1:0] pipe_tag;
+    wire [STAGES-1:0] pipe_valid;
+
+    // Stage inputs: the pipeline input followed by every stage register
+    wire [(STAGES+1)*1600-1:0] chain_state = {pipe_state, in_state};
+    wire [(STAGES+1)*TAG_WIDTH-1:0] chain_tag = {pipe_tag, in_tag};
+    wire [STAGES:0] chain_valid = {pipe_valid, in_valid};
+
+    // Pipeline advances when the last stage is empty or being drained
+    wire advance = out_ready || !pipe_valid[STAGES-1];
+
+    genvar si;
+    generate
+        for (si = 0; si < STAGES; si = si + 1) begin : stage
+            localparam [4:0] ROUND = si;
+            wire [1599:0] round_out;
+            reg [1599:0] state_r;
+            reg [TAG_WIDTH-1:0] tag_r;
+            reg valid_r;
+
+            keccak_round k_round (
+                .state_in (chain_state[si*1600 +: 1600]),
+                .round (ROUND),
+                .state_out (round_out)
+            );
+
+            // Only the valid bits need a reset; data follows valid
+            always @(posedge clk or negedge rst_n) begin
+                if (!rst_n)
+                    valid_r <= 1'b0;
+                else if (advance)
+                    valid_r <= chain_valid[si];
+            end
+
+            always @(posedge clk) begin
+                if (advance) begin
+                    state_r <= round_out;
+                    tag_r <= chain_tag[si*TAG_WIDTH +: TAG_WIDTH];
+                end
+            end
+
+            assign pipe_state[si*1600 +: 1600] = state_r;
+            assign pipe_tag[si*TAG_WIDTH +: TAG_WIDTH] = tag_r;
+            assign pipe_valid[si] = valid_r;
+        end
+    endgenerate
+
+    // Outputs
+    assign in_ready = advance;
+    assign out_state = pipe_state[(STAGES-1)*1600 +: 1600];
+    assign out_tag = pipe_tag[(STAGES-1)*TAG_WIDTH +: TAG_WIDTH];
+    assign out_valid = pipe_valid[STAGES-1];
+
+endmodule
\ No newline at end of file
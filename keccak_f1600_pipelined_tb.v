@@ -0,0 +1,205 @@
+`timescale 1ns / 1ps
+
+module keccak_f1600_pipelined_tb;
+
+    // DUT signals
+    reg          clk;
+    reg          rst_n;
+    reg  [1599:0] in_state;
+    reg  [7:0]   in_tag;
+    reg          in_valid;
+    wire         in_ready;
+    wire [1599:0] out_state;
+    wire [7:0]   out_tag;
+    wire         out_valid;
+    reg          out_ready;
+
+    // Instantiate DUT
+    keccak_f1600_pipelined #(
+        .TAG_WIDTH (8)
+    ) uut (
+        .clk       (clk),
+        .rst_n     (rst_n),
+        .in_state  (in_state),
+        .in_tag    (in_tag),
+        .in_valid  (in_valid),
+        .in_ready  (in_ready),
+        .out_state (out_state),
+        .out_tag   (out_tag),
+        .out_valid (out_valid),
+        .out_ready (out_ready)
+    );
+
+    // 10 ns clock period
+    always #5 clk = ~clk;
+
+    // Reference vectors: 4 test cases x 25 lanes = 100 entries
+    // Generated by gen_f1600_vectors.cpp (tests 1 and 2 are used here)
+    reg [63:0] expected_lanes [0:99];
+
+    integer errors, sent, received, cycle;
+    integer first_accept, first_output, stall_cycles;
+    reg throttle;
+    reg [15:0] lfsr;
+
+    // Even tags carry the all-zero state, odd tags lane0 = 0xDEADBEEFCAFEBABE
+    function [1599:0] input_for_tag;
+        input [7:0] tag;
+        begin
+            input_for_tag = 1600'd0;
+            if (tag[0])
+                input_for_tag[63:0] = 64'hDEADBEEFCAFEBABE;
+        end
+    endfunction
+
+    function [1599:0] expected_for_tag;
+        input [7:0] tag;
+        integer k;
+        begin
+            for (k = 0; k < 25; k = k + 1)
+                expected_for_tag[k*64 +: 64] = expected_lanes[(tag[0] ? 25 : 0) + k];
+        end
+    endfunction
+
+    always @(posedge clk) begin
+        if (!rst_n)
+            cycle <= 0;
+        else
+            cycle <= cycle + 1;
+    end
+
+    // Backpressure: out_ready follows an LFSR bit while throttling
+    always @(posedge clk) begin
+        if (!rst_n) begin
+            lfsr <= 16'hACE1;
+            out_ready <= 1'b1;
+        end
+        else begin
+            lfsr <= {lfsr[14:0], lfsr[15] ^ lfsr[13] ^ lfsr[12] ^ lfsr[10]};
+            out_ready <= throttle ? lfsr[0] : 1'b1;
+        end
+    end
+
+    // Check every result as it leaves the pipeline
+    always @(posedge clk) begin
+        if (rst_n && out_valid && out_ready) begin
+            if (received == 0)
+                first_output = cycle;
+
+            if (out_tag !== received[7:0]) begin
+                $display("  FAIL: result %0d has tag %0d", received, out_tag);
+                errors = errors + 1;
+            end
+            else if (out_state !== expected_for_tag(out_tag)) begin
+                $display("  FAIL: result %0d (tag %0d) has wrong state", received, out_tag);
+                errors = errors + 1;
+            end
+            received = received + 1;
+        end
+    end
+
+    // Send count states with consecutive tags, holding in_valid high
+    task send_stream;
+        input integer count;
+        integer k;
+        begin
+            for (k = 0; k < count; k = k + 1) begin
+                in_state = input_for_tag(sent[7:0]);
+                in_tag   = sent[7:0];
+                in_valid = 1;
+                while (!in_ready) begin
+                    @(posedge clk); #1;
+                    stall_cycles = stall_cycles + 1;
+                end
+                if (sent == 0)
+                    first_accept = cycle;
+                @(posedge clk); #1;
+                sent = sent + 1;
+            end
+            in_valid = 0;
+        end
+    endtask
+
+    task wait_drained;
+        integer timeout;
+        begin
+            timeout = 0;
+            while (received < sent && timeout < 1000) begin
+                @(posedge clk); #1;
+                timeout = timeout + 1;
+            end
+            if (received != sent) begin
+                $display("  FAIL: %0d of %0d results received", received, sent);
+                errors = errors + 1;
+            end
+        end
+    endtask
+
+    initial begin
+        $dumpfile("keccak_f1600_pipelined_tb.vcd");
+        $dumpvars(0, keccak_f1600_pipelined_tb);
+
+        $readmemh("f1600_vectors.hex", expected_lanes);
+
+        clk      = 0;
+        rst_n    = 0;
+        in_state = 1600'd0;
+        in_tag   = 8'd0;
+        in_valid = 0;
+        throttle = 0;
+        errors   = 0;
+        sent     = 0;
+        received = 0;
+        stall_cycles = 0;
+
+        // ============================================
+        // Reset
+        // ============================================
+        #20;
+        rst_n = 1;
+        @(posedge clk);
+        #1;
+
+        // ============================================
+        // Test 1: 16 states back-to-back, no backpressure
+        // One state accepted per cycle, first result 24 cycles later
+        // ============================================
+        $display("\n=== Test 1: Back-to-back states ===");
+        send_stream(16);
+        wait_drained;
+
+        if (stall_cycles != 0) begin
+            $display("FAIL: input stalled for %0d cycles without backpressure", stall_cycles);
+            errors = errors + 1;
+        end
+        if (first_output - first_accept != 24) begin
+            $display("FAIL: latency %0d cycles, expected 24", first_output - first_accept);
+            errors = errors + 1;
+        end
+        else
+            $display("OK: 16 states in 16 cycles, latency 24 cycles");
+
+        // ============================================
+        // Test 2: 32 states with random out_ready
+        // Results must stay in order and intact under stalls
+        // ============================================
+        $display("\n=== Test 2: Backpressure ===");
+        throttle = 1;
+        send_stream(32);
+        wait_drained;
+        throttle = 0;
+        $display("OK: %0d results received, input stalled %0d cycles", received, stall_cycles);
+
+        // ============================================
+        // Summary
+        // ============================================
+        $display("\n=== Summary ===");
+        if (errors == 0)
+            $display("ALL TESTS PASSED");
+        else
+            $display("FAILED: %0d error(s)", errors);
+
+        $finish;
+    end
+
+endmodule
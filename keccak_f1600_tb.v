@@ -1,21 +1,29 @@
 `timescale 1ns / 1ps
 
-module keccak_f1600_tb;
+module keccak_f1600_tb #(
+    // Override to check the unrolled cores, e.g.
+    //   iverilog -P keccak_f1600_tb.ROUNDS_PER_CYCLE=4 ...
+    parameter ROUNDS_PER_CYCLE = 1
+);
 
     // DUT signals
     reg          clk;
     reg          rst_n;
     reg          start;
+    reg          chain;
     reg  [1599:0] state_in;
     wire [1599:0] state_out;
     wire         ready;
     wire         done;
 
     // Instantiate DUT
-    keccak_f1600 uut (
+    keccak_f1600 #(
+        .ROUNDS_PER_CYCLE(ROUNDS_PER_CYCLE)
+    ) uut (
         .clk       (clk),
         .rst_n     (rst_n),
         .start     (start),
+        .chain     (chain),
         .state_in  (state_in),
         .state_out (state_out),
         .ready     (ready),
@@ -25,11 +33,12 @@ module keccak_f1600_tb;
     // 10 ns clock period
     always #5 clk = ~clk;
 
-    // Reference vectors: 2 test cases x 25 lanes = 50 entries
+    // Reference vectors: 4 test cases x 25 lanes = 100 entries
     // Generated by gen_f1600_vectors.cpp
-    reg [63:0] expected_lanes [0:49];
+    reg [63:0] expected_lanes [0:99];
 
     integer i, errors;
+    integer latency;
     reg [1599:0] expected_state;
 
     // Display all 25 lanes
@@ -79,6 +88,26 @@ module keccak_f1600_tb;
         end
     endtask
 
+    // Resume from IDLE on the previous output: start with chain skips the
+    // load cycle. Counts cycles from the edge that sampled start.
+    task resume_permutation;
+        begin
+            @(posedge clk);
+            start <= 1;
+            chain <= 1;
+            @(posedge clk);
+            start <= 0;
+            chain <= 0;
+            #1;
+            latency = 1;
+            while (done !== 1'b1) begin
+                @(posedge clk);
+                #1;
+                latency = latency + 1;
+            end
+        end
+    endtask
+
     // Run one permutation: set state_in, pulse start, wait for result
     task run_permutation;
         input [1599:0] input_state;
@@ -89,9 +118,15 @@ module keccak_f1600_tb;
             @(posedge clk);
             start <= 0;
 
-            // Wait for done (registered: state_out is valid when done is high)
-            wait (done == 1);
+            // Wait for done (registered: state_out is valid when done is high),
+            // counting cycles from the edge that sampled start
             #1;
+            latency = 1;
+            while (done !== 1'b1) begin
+                @(posedge clk);
+                #1;
+                latency = latency + 1;
+            end
         end
     endtask
 
@@ -104,6 +139,7 @@ module keccak_f1600_tb;
         clk   = 0;
         rst_n = 0;
         start = 0;
+        chain = 0;
         state_in = 1600'd0;
         errors = 0;
 
@@ -135,6 +171,13 @@ module keccak_f1600_tb;
 
         check_output(1, 0);
 
+        // Load cycle + 24/R rounds + registered done
+        if (latency != 24 / ROUNDS_PER_CYCLE + 1) begin
+            $display("FAIL: done after %0d cycles, expected %0d", latency, 24 / ROUNDS_PER_CYCLE + 1);
+            errors = errors + 1;
+        end else
+            $display("OK: done after %0d cycles (ROUNDS_PER_CYCLE=%0d)", latency, ROUNDS_PER_CYCLE);
+
         // ============================================
         // Test 2: keccak_f1600(lane0 = 0xDEADBEEFCAFEBABE)
         // ============================================
@@ -157,6 +200,30 @@ module keccak_f1600_tb;
         run_permutation(1600'd0);
         check_output(3, 0);
 
+        // ============================================
+        // Test 4: Resume from IDLE on the previous output
+        // Test 3 left f(0) in the core; start with chain
+        // permutes it again without a load cycle.
+        // ============================================
+        $display("\n=== Test 4: Resume (all-zeros x2) ===");
+        resume_permutation;
+        if (latency != 24 / ROUNDS_PER_CYCLE) begin
+            $display("FAIL: resumed block after %0d cycles, expected %0d", latency, 24 / ROUNDS_PER_CYCLE);
+            errors = errors + 1;
+        end
+        check_output(4, 50);
+
+        // ============================================
+        // Test 5: Resume again (all-zeros x3)
+        // ============================================
+        $display("\n=== Test 5: Resume (all-zeros x3) ===");
+        resume_permutation;
+        if (latency != 24 / ROUNDS_PER_CYCLE) begin
+            $display("FAIL: resumed block after %0d cycles, expected %0d", latency, 24 / ROUNDS_PER_CYCLE);
+            errors = errors + 1;
+        end
+        check_output(5, 75);
+
         // ============================================
         // Summary
         // ============================================
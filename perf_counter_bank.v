@@ -0,0 +1,59 @@
+// INSTANCES sets of perf_counters behind one register interface: set i
+// counts events[i*NUM_EVENTS +: NUM_EVENTS], and csr_sel picks the set a
+// csr_* access goes to (registers as in perf_counters). Read data comes
+// from the set that was read, with csr_rd_valid one cycle after csr_rd_en.
+module perf_counter_bank #(
+    parameter NUM_EVENTS = 10,
+    parameter COUNTER_WIDTH = 32, // <= 32
+    parameter ADDR_WIDTH = 5,     // 2^ADDR_WIDTH > NUM_EVENTS
+    parameter INSTANCES = 2
+) (
+    input wire clk,
+    input wire rst_n,
+
+    input wire [INSTANCES*NUM_EVENTS-1:0] events,
+
+    input wire [((INSTANCES > 1) ? $clog2(INSTANCES) : 1)-1:0] csr_sel,
+    input wire [ADDR_WIDTH-1:0] csr_addr,
+    input wire csr_wr_en,
+    input wire [31:0] csr_wr_data,
+    input wire csr_rd_en,
+    output reg [31:0] csr_rd_data,
+    output wire csr_rd_valid
+);
+
+    wire [INSTANCES*32-1:0] set_rd_data;
+    wire [INSTANCES-1:0] set_rd_valid;
+
+    genvar g;
+    generate
+        for (g = 0; g < INSTANCES; g = g + 1) begin : set
+            perf_counters #(
+                .NUM_EVENTS(NUM_EVENTS),
+                .COUNTER_WIDTH(COUNTER_WIDTH),
+                .ADDR_WIDTH(ADDR_WIDTH)
+            ) counters (
+                .clk(clk),
+                .rst_n(rst_n),
+                .events(events[g*NUM_EVENTS +: NUM_EVENTS]),
+                .csr_addr(csr_addr),
+                .csr_wr_en(csr_wr_en && (csr_sel == g)),
+                .csr_wr_data(csr_wr_data),
+                .csr_rd_en(csr_rd_en && (csr_sel == g)),
+                .csr_rd_data(set_rd_data[g*32 +: 32]),
+                .csr_rd_valid(set_rd_valid[g])
+            );
+        end
+    endgenerate
+
+    // At most one set answers a read; the others hold stale read data
+    integer i;
+    always @(*) begin
+        csr_rd_data = 32'd0;
+        for (i = 0; i < INSTANCES; i = i + 1)
+            if (set_rd_valid[i])
+                csr_rd_data = csr_rd_data | set_rd_data[i*32 +: 32];
+    end
+    assign csr_rd_valid = |set_rd_valid;
+
+endmodule
@@ -0,0 +1,72 @@
+// Event counters behind a small register interface. Counter e adds one on
+// every cycle events[e] is high (events are registered first, so counts
+// lag by a cycle) and wraps at 2^COUNTER_WIDTH.
+//
+// Registers (32-bit words, csr_addr):
+//   0       control: [0] enable (reset 1), [1] clear all (write 1, reads 0),
+//           [15:8] NUM_EVENTS (read only)
+//   1 + e   counter e; any write clears it
+// Reads return csr_rd_data with csr_rd_valid one cycle after csr_rd_en.
+// Clear enable to freeze all counters for a consistent snapshot.
+module perf_counters #(
+    parameter NUM_EVENTS = 10,
+    parameter COUNTER_WIDTH = 32, // <= 32
+    parameter ADDR_WIDTH = 5      // 2^ADDR_WIDTH > NUM_EVENTS
+) (
+    input wire clk,
+    input wire rst_n,
+
+    input wire [NUM_EVENTS-1:0] events,
+
+    input wire [ADDR_WIDTH-1:0] csr_addr,
+    input wire csr_wr_en,
+    input wire [31:0] csr_wr_data,
+    input wire csr_rd_en,
+    output reg [31:0] csr_rd_data,
+    output reg csr_rd_valid
+);
+
+    localparam [7:0] EVENT_COUNT = NUM_EVENTS;
+
+    reg [NUM_EVENTS-1:0] events_reg;
+    reg [COUNTER_WIDTH-1:0] counters [0:NUM_EVENTS-1];
+    reg enable;
+
+    wire clear_all = csr_wr_en && (csr_addr == 0) && csr_wr_data[1];
+
+    integer e;
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            events_reg <= {NUM_EVENTS{1'b0}};
+            enable <= 1'b1;
+            csr_rd_data <= 32'd0;
+            csr_rd_valid <= 1'b0;
+            for (e = 0; e < NUM_EVENTS; e = e + 1)
+                counters[e] <= {COUNTER_WIDTH{1'b0}};
+        end
+        else begin
+            events_reg <= events;
+
+            for (e = 0; e < NUM_EVENTS; e = e + 1) begin
+                if (clear_all || (csr_wr_en && csr_addr == e + 1))
+                    counters[e] <= {COUNTER_WIDTH{1'b0}};
+                else if (enable && events_reg[e])
+                    counters[e] <= counters[e] + 1'd1;
+            end
+
+            if (csr_wr_en && csr_addr == 0)
+                enable <= csr_wr_data[0];
+
+            csr_rd_valid <= csr_rd_en;
+            if (csr_rd_en) begin
+                if (csr_addr == 0)
+                    csr_rd_data <= {16'd0, EVENT_COUNT, 7'd0, enable};
+                else if (csr_addr <= NUM_EVENTS)
+                    csr_rd_data <= counters[csr_addr - 1'd1]; // zero-extended
+                else
+                    csr_rd_data <= 32'd0;
+            end
+        end
+    end
+
+endmodule
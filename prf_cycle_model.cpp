@@ -0,0 +1,366 @@
+// Cycle-approximate transaction-level model of the PRF datapath:
+//   hash_to_vector (shake256 + keccak_f1600) -> dot_product -> prf_rounding
+//
+// Each slot is walked through the shake256 FSM (S_IDLE .. S_DONE) one
+// state at a time. Instead of clocking 1600-bit registers, every state is
+// charged the number of cycles the RTL spends in it, so millions of slots
+// can be simulated per second. Cycle counts are reported per slot together
+// with a breakdown of where the cycles go.
+//
+// Assumptions:
+//   - Every slot of a run takes the same path through the FSM, picked by
+//     the nonce length: the index either fits in the nonce's tail block or
+//     straddles into the next one. A run cannot mix the two.
+//   - The nonce itself (its full rate blocks, absorbed into the midstate
+//     once per message) is not charged; the model starts with the nonce
+//     loaded.
+//   - The consumer is the adder-tree dot_product (DOT_IMPL 0). Its tail
+//     overlaps the next slot's hash, so the tree and accumulator drain is
+//     charged once, to the first slot.
+//
+// Compile and run:
+//   g++ -O2 -o prf_cycle_model prf_cycle_model.cpp && ./prf_cycle_model
+//
+// Options:
+//   --rounds-per-cycle R   keccak rounds evaluated per clock (divides 24)
+//   --lanes-per-cycle L    squeeze lanes delivered per beat (1..17)
+//   --absorb-lanes A       absorb lanes accepted per beat (1..17)
+//   --elem-lanes K         hash elements accumulated per cycle by dot_product
+//   --n N_LWR              vector dimension (default 445)
+//   --nonce-bytes B        nonce length in bytes (default 8)
+//   --slots S              number of slots to simulate (default 1000000)
+//   --fmax MHZ             clock used for the slots/s estimate (default 100)
+//   --no-midstate          absorb nonce || index beat by beat every slot
+//                          instead of loading the nonce midstate template
+//   --csv                  print a single CSV line instead of the report:
+//                          R,L,A,K,n,nonce,cycles,perms,slots_per_s,<breakdown...>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static const int RATE_LANES = 17;
+static const int KECCAK_ROUNDS = 24;
+
+struct ModelConfig {
+    int rounds_per_cycle = 1;
+    int lanes_per_cycle = 1;
+    int absorb_lanes = 2; // --no-midstate: nonce || index in one beat
+    int elem_lanes = 1;
+    int n_lwr = 445;
+    int nonce_bytes = 8;
+    long slots = 1000000;
+    double fmax_mhz = 100.0;
+    bool midstate = true; // hash_to_vector loads the per-nonce template
+    bool csv = false;
+};
+
+// Cycle categories. Every simulated cycle lands in exactly one of these.
+enum Category {
+    C_HANDSHAKE,    // start/done handshakes between modules
+    C_ABSORB,       // S_ABSORB beats
+    C_ABSORB_PERM,  // S_ABSORB_PERM waiting on keccak_f1600
+    C_PAD,          // S_PAD
+    C_PAD_PERM,     // S_PAD_PERM waiting on keccak_f1600
+    C_SQUEEZE,      // S_SQUEEZE beats accepted by the consumer
+    C_SQUEEZE_PERM, // S_SQUEEZE_PERM waiting on keccak_f1600
+    C_READY_STALL,  // S_SQUEEZE with data_out_ready low (dot_product busy)
+    C_DOT_DRAIN,    // dot_product finishing after the last element
+    C_COUNT
+};
+
+static const char *CATEGORY_NAMES[C_COUNT] = {
+    "handshake", "absorb", "absorb_perm", "pad", "pad_perm",
+    "squeeze", "squeeze_perm", "ready_stall", "dot_drain"
+};
+
+struct Stats {
+    uint64_t cycles[C_COUNT] = {};
+    uint64_t permutations = 0;
+    uint64_t slots = 0;
+
+    uint64_t total() const {
+        uint64_t t = 0;
+        for (int i = 0; i < C_COUNT; i++)
+            t += cycles[i];
+        return t;
+    }
+};
+
+// keccak_f1600: one IDLE cycle to load state_in on start, 24/R RUNNING
+// cycles, then done_r is registered one cycle behind the final round.
+// shake256 raises perm_start one cycle after deciding to permute and
+// copies perm_state_out in the cycle it sees done, so the caller sits in
+// its S_*_PERM state for 2 + 24/R cycles.
+static int perm_wait_cycles(const ModelConfig& cfg) {
+    return 2 + KECCAK_ROUNDS / cfg.rounds_per_cycle;
+}
+
+// Squeeze permutations overlap the output: shake256 copies each block into
+// its rate buffer and restarts keccak_f1600 on its own output in the same
+// cycle, so the next block is ready 24/R cycles later. The buffer sits
+// empty only for the part of that time not spent draining the previous
+// block (block_cycles, beats plus ready stalls).
+static int squeeze_perm_wait_cycles(const ModelConfig& cfg, int block_cycles) {
+    int wait = KECCAK_ROUNDS / cfg.rounds_per_cycle - block_cycles;
+    return wait > 0 ? wait : 0;
+}
+
+enum ShakeState {
+    S_IDLE, S_ABSORB, S_ABSORB_PERM, S_PAD, S_PAD_PERM,
+    S_SQUEEZE, S_SQUEEZE_PERM, S_DONE
+};
+
+// dot_product raises done $clog2(LANES) + 1 edges after it samples the
+// last beat (adder tree, then accumulator); prf_rounding is combinational.
+static int dot_drain_cycles(const ModelConfig& cfg) {
+    int levels = 0;
+    while ((1 << levels) < cfg.elem_lanes)
+        levels++;
+    return levels + 1;
+}
+
+// Walk one (nonce || index_le64) hash and its dot product through the
+// shake256 FSM and charge each state its cycle cost.
+static void simulate_slot(const ModelConfig& cfg, Stats& st) {
+    const int msg_bytes = cfg.nonce_bytes + 8;
+    int words_left = (msg_bytes + 7) / 8;
+    const bool last_word_full = (msg_bytes % 8) == 0 && msg_bytes > 0;
+    if (words_left == 0)
+        words_left = 1; // empty message is one keep=0 word
+
+    int lanes_left = cfg.n_lwr; // one 64-bit lane per hash element
+    int lane = 0;
+    bool pad_after_perm = false;
+    const int perm = perm_wait_cycles(cfg);
+    int block_cycles = 0; // cycles spent draining the last squeezed block
+
+    // prf_evaluate issues the next queued request in the cycle the previous
+    // slot's last element leaves hash_to_vector, which latches it and
+    // starts shake256 (S_DONE -> S_ABSORB) one cycle later. With the
+    // nonce midstate that cycle loads the template block instead: the
+    // nonce's full blocks were absorbed once per message (not charged
+    // here), so shake256 goes straight to S_PAD_PERM, or, when the index
+    // runs past the end of the block, permutes it as a midstate and
+    // absorbs the remaining index bytes as one short beat.
+    st.cycles[C_HANDSHAKE] += 1;
+
+    ShakeState state = S_ABSORB;
+    if (cfg.midstate) {
+        st.cycles[C_ABSORB] += 1;
+        if (cfg.nonce_bytes % (RATE_LANES * 8) < RATE_LANES * 8 - 8) {
+            state = S_PAD_PERM;
+        }
+        else {
+            words_left = 1;
+            lane = 0;
+            state = S_ABSORB_PERM;
+        }
+    }
+    else {
+        st.cycles[C_HANDSHAKE] += 1;
+    }
+    while (state != S_DONE) {
+        switch (state) {
+        case S_ABSORB: {
+            int take = words_left < cfg.absorb_lanes ? words_left : cfg.absorb_lanes;
+            st.cycles[C_ABSORB] += 1;
+            lane += take;
+            words_left -= take;
+            if (words_left == 0) {
+                // Full final lane at the end of the rate: permute, then pad
+                if (lane > RATE_LANES || (lane == RATE_LANES && last_word_full)) {
+                    pad_after_perm = true;
+                    lane -= RATE_LANES;
+                    state = S_ABSORB_PERM;
+                }
+                else {
+                    state = S_PAD;
+                }
+            }
+            else if (lane >= RATE_LANES) {
+                lane -= RATE_LANES;
+                state = S_ABSORB_PERM;
+            }
+            break;
+        }
+
+        case S_ABSORB_PERM:
+            st.cycles[C_ABSORB_PERM] += perm;
+            st.permutations++;
+            state = pad_after_perm ? S_PAD : S_ABSORB;
+            pad_after_perm = false;
+            break;
+
+        case S_PAD:
+            st.cycles[C_PAD] += 1;
+            state = S_PAD_PERM;
+            break;
+
+        case S_PAD_PERM:
+            st.cycles[C_PAD_PERM] += perm;
+            st.permutations++;
+            lane = 0;
+            state = lanes_left > 0 ? S_SQUEEZE : S_DONE;
+            break;
+
+        case S_SQUEEZE: {
+            // Charge every beat up to the end of this rate block at once:
+            // full beats of lanes_per_cycle lanes plus one partial beat.
+            int avail = RATE_LANES - lane;
+            if (avail > lanes_left)
+                avail = lanes_left;
+            int full_beats = avail / cfg.lanes_per_cycle;
+            int tail = avail % cfg.lanes_per_cycle;
+
+            // dot_product accepts elem_lanes elements per cycle; a wider
+            // beat holds data_out_ready low until it has been consumed.
+            int full_cost = (cfg.lanes_per_cycle + cfg.elem_lanes - 1) / cfg.elem_lanes;
+            int tail_cost = (tail + cfg.elem_lanes - 1) / cfg.elem_lanes;
+            int beats = full_beats + (tail ? 1 : 0);
+            block_cycles = beats + full_beats * (full_cost - 1) + (tail ? tail_cost - 1 : 0);
+            st.cycles[C_SQUEEZE] += beats;
+            st.cycles[C_READY_STALL] += block_cycles - beats;
+
+            lane += avail;
+            lanes_left -= avail;
+            if (lanes_left == 0)
+                state = S_DONE;
+            else
+                state = S_SQUEEZE_PERM;
+            break;
+        }
+
+        case S_SQUEEZE_PERM:
+            st.cycles[C_SQUEEZE_PERM] += squeeze_perm_wait_cycles(cfg, block_cycles);
+            st.permutations++;
+            lane = 0;
+            state = S_SQUEEZE;
+            break;
+
+        default:
+            state = S_DONE;
+            break;
+        }
+    }
+
+    // The dot product and rounding of this slot overlap the next slot's
+    // hash (prf_evaluate request queue); only one drain is exposed per run
+    if (st.slots == 0)
+        st.cycles[C_DOT_DRAIN] += dot_drain_cycles(cfg);
+    st.slots++;
+}
+
+static bool divides_rounds(int r) {
+    return r > 0 && r <= KECCAK_ROUNDS && (KECCAK_ROUNDS % r) == 0;
+}
+
+static int parse_int(const char *flag, const char *value, int lo, int hi) {
+    char *end = nullptr;
+    long v = strtol(value, &end, 10);
+    if (!end || *end != '\0' || v < lo || v > hi) {
+        fprintf(stderr, "Error: %s expects an integer in [%d, %d], got '%s'\n",
+                flag, lo, hi, value);
+        exit(1);
+    }
+    return (int)v;
+}
+
+static ModelConfig parse_args(int argc, char **argv) {
+    ModelConfig cfg;
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (!strcmp(arg, "--no-midstate")) {
+            cfg.midstate = false;
+            continue;
+        }
+        if (!strcmp(arg, "--csv")) {
+            cfg.csv = true;
+            continue;
+        }
+        if (!val) {
+            fprintf(stderr, "Error: %s needs a value\n", arg);
+            exit(1);
+        }
+
+        if (!strcmp(arg, "--rounds-per-cycle"))
+            cfg.rounds_per_cycle = parse_int(arg, val, 1, KECCAK_ROUNDS);
+        else if (!strcmp(arg, "--lanes-per-cycle"))
+            cfg.lanes_per_cycle = parse_int(arg, val, 1, RATE_LANES);
+        else if (!strcmp(arg, "--absorb-lanes"))
+            cfg.absorb_lanes = parse_int(arg, val, 1, RATE_LANES);
+        else if (!strcmp(arg, "--elem-lanes"))
+            cfg.elem_lanes = parse_int(arg, val, 1, 64);
+        else if (!strcmp(arg, "--n"))
+            cfg.n_lwr = parse_int(arg, val, 1, 1 << 16);
+        else if (!strcmp(arg, "--nonce-bytes"))
+            cfg.nonce_bytes = parse_int(arg, val, 0, 1 << 16);
+        else if (!strcmp(arg, "--slots"))
+            cfg.slots = parse_int(arg, val, 1, 1 << 30);
+        else if (!strcmp(arg, "--fmax"))
+            cfg.fmax_mhz = parse_int(arg, val, 1, 2000);
+        else {
+            fprintf(stderr, "Error: unknown option %s\n", arg);
+            exit(1);
+        }
+        i++;
+    }
+
+    if (!divides_rounds(cfg.rounds_per_cycle)) {
+        fprintf(stderr, "Error: --rounds-per-cycle must divide 24\n");
+        exit(1);
+    }
+    return cfg;
+}
+
+int main(int argc, char **argv) {
+    ModelConfig cfg = parse_args(argc, argv);
+    Stats st;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (long s = 0; s < cfg.slots; s++)
+        simulate_slot(cfg, st);
+    auto t1 = std::chrono::steady_clock::now();
+
+    double wall = std::chrono::duration<double>(t1 - t0).count();
+    double per_slot = (double)st.total() / (double)st.slots;
+    double perms_per_slot = (double)st.permutations / (double)st.slots;
+    double slots_per_sec = cfg.fmax_mhz * 1e6 / per_slot;
+
+    if (cfg.csv) {
+        printf("%d,%d,%d,%d,%d,%d,%.2f,%.2f,%.0f",
+               cfg.rounds_per_cycle, cfg.lanes_per_cycle, cfg.absorb_lanes,
+               cfg.elem_lanes, cfg.n_lwr, cfg.nonce_bytes,
+               per_slot, perms_per_slot, slots_per_sec);
+        for (int i = 0; i < C_COUNT; i++)
+            printf(",%.2f", (double)st.cycles[i] / (double)st.slots);
+        printf("\n");
+        return 0;
+    }
+
+    printf("================================================================================\n");
+    printf("LWR-PRF cycle model\n");
+    printf("================================================================================\n");
+    printf("Parameters: N_LWR=%d, nonce=%d bytes, rounds/cycle=%d, squeeze lanes=%d, "
+           "absorb lanes=%d, elem lanes=%d\n",
+           cfg.n_lwr, cfg.nonce_bytes, cfg.rounds_per_cycle, cfg.lanes_per_cycle,
+           cfg.absorb_lanes, cfg.elem_lanes);
+    printf("\n");
+    printf("  Cycles per slot:       %.2f\n", per_slot);
+    printf("  Permutations per slot: %.2f\n", perms_per_slot);
+    printf("  Slots/s @ %.0f MHz:     %.0f\n", cfg.fmax_mhz, slots_per_sec);
+    printf("\n");
+    printf("  Breakdown (cycles per slot):\n");
+    for (int i = 0; i < C_COUNT; i++) {
+        double c = (double)st.cycles[i] / (double)st.slots;
+        printf("    %-14s %9.2f  (%5.1f%%)\n", CATEGORY_NAMES[i], c, 100.0 * c / per_slot);
+    }
+    printf("\n");
+    printf("  Simulated %lu slots in %.3f s (%.2f M slots/s)\n",
+           (unsigned long)st.slots, wall, (double)st.slots / wall / 1e6);
+    return 0;
+}
@@ -1,89 +1,284 @@
+// The nonce is streamed in once per message (nonce_* as in hash_to_vector)
+// and used by every request after it. The request queue follows the
+// nonce rule of hash_to_vector: ready needs its nonce_loaded, and
+// nonce_ready is low while the queue holds or takes a request. Requests
+// (start with index) are queued while ready is high and evaluated in
+// order. The next slot's hash starts as soon as the current slot's last
+// element leaves hash_to_vector, overlapping the dot product and rounding
+// tail. done pulses once per slot with prf_out and the slot's prf_index.
+//
+// With NUM_KEYS > 1 each hash vector is evaluated against NUM_KEYS keys at
+// once: key k has its own key store (key_wr_key selects it for writes,
+// key_swap rotates all of them together; KEY_FILE initialises key 0 only)
+// and its output in prf_out[k*$clog2(P) +: $clog2(P)].
+//
+// Performance counters (perf_counters, registers on perf_*) count
+// perf_events[e] in counter register 1 + e, one per cycle the bit is
+// high. Bits 0-5 come from hash_to_vector (see shake256 for [2]-[4]).
+//   Cycle counts: [0] keccak_f1600 busy, [2] shake256 busy, [3] absorb
+//     stall, [4] squeeze stall, [5] hash_to_vector busy, [8] slot in
+//     flight (start to done), [9] gap: a slot in flight but no element
+//     reaching the dot product.
+//   Event counts: [1] permutations, [6] element beats into the dot
+//     product (one per accepted beat, not its busy time), [7] slots done.
 module prf_evaluate #(
     parameter N_LWR = 445,
     parameter N = 2048,
-    parameter P = 32
+    parameter P = 32,
+    parameter ROUNDS_PER_CYCLE = 1, // keccak_f1600 rounds per clock
+    parameter ELEMS_PER_CYCLE = 1,  // hash elements squeezed and summed per beat (1-17)
+    parameter QUEUE_DEPTH = 4,      // pending requests, power of 2 (>= 2)
+    parameter KEY_FILE = "secret_key.mem", // initial key, "" for none
+    parameter KEY_WORD_WIDTH = 32,  // key store word, power of 2 (>= ELEMS_PER_CYCLE)
+    parameter NUM_KEYS = 1,         // keys evaluated per slot
+    parameter DOT_IMPL = 0          // 0: adder tree (dot_product), 1: bit-plane popcount
 ) (
     input wire clk,
     input wire rst_n,
 
     input wire start,
+    output wire ready,              // request queue has room
+
+    input wire [63:0] nonce_data,
+    input wire [7:0] nonce_keep,
+    input wire nonce_valid,
+    input wire nonce_last,
+    output wire nonce_ready,
 
-    input wire [63:0] nonce,
     input wire [63:0] index,
 
-    output wire [$clog2(P)-1:0] prf_out,
-    output wire done
+    // Key store: words written to the shadow bank, which key_swap makes
+    // active between slots (key_swap_pending until then)
+    input wire key_wr_en,
+    input wire [((NUM_KEYS > 1) ? $clog2(NUM_KEYS) : 1)-1:0] key_wr_key,
+    input wire [$clog2(N_LWR)-1:0] key_wr_addr,
+    input wire [KEY_WORD_WIDTH-1:0] key_wr_data,
+    input wire key_swap,
+    output wire key_swap_pending,
+
+    output wire [NUM_KEYS*$clog2(P)-1:0] prf_out,
+    output wire [63:0] prf_index,
+    output wire done,
+
+    // Performance counters (see perf_counters)
+    output wire [9:0] perf_events,
+    input wire [4:0] perf_addr,
+    input wire perf_wr_en,
+    input wire [31:0] perf_wr_data,
+    input wire perf_rd_en,
+    output wire [31:0] perf_rd_data,
+    output wire perf_rd_valid
 );
 
     localparam ELEM_WIDTH = $clog2(N) + 1;
-    localparam ACC_WIDTH = 32;
+    localparam ACC_WIDTH = ELEM_WIDTH; // prf_rounding reads <a, s> mod 2N only
     localparam ADDR_WIDTH = $clog2(N_LWR);
     localparam OUT_WIDTH = $clog2(P);
+    localparam QPTR_WIDTH = (QUEUE_DEPTH > 1) ? $clog2(QUEUE_DEPTH) : 1;
+
+    // Request queue
+    reg [63:0] q_index [0:QUEUE_DEPTH-1];
+    reg [QPTR_WIDTH-1:0] q_wr;
+    reg [QPTR_WIDTH-1:0] q_rd;
+    reg [QPTR_WIDTH:0] q_count;
+
+    // Slot in hash_to_vector and slot in the dot product tail
+    wire hash_ready;
+    wire hash_nonce_ready;
+    wire hash_nonce_loaded;
+    reg [63:0] hash_index;
+    reg [63:0] dot_index;
+    reg slot_active; // hash_to_vector is streaming a slot's elements
+    reg tail_active; // last element sent, dot product result pending
 
-    wire [ELEM_WIDTH-1:0] hash;
     wire [ADDR_WIDTH-1:0] idx;
+    wire [ELEMS_PER_CYCLE-1:0] mask;
     wire valid;
     wire last;
-    wire key_bit;
-    wire [ELEM_WIDTH-1:0] a_in;
+    wire [NUM_KEYS*ELEMS_PER_CYCLE-1:0] key_bits;
+    wire [NUM_KEYS-1:0] swap_pending;
+    wire [ELEMS_PER_CYCLE*ELEM_WIDTH-1:0] a_in;
 
-    wire [ACC_WIDTH-1:0] dot_prod;
+    wire [NUM_KEYS*ACC_WIDTH-1:0] dot_prods;
     wire dot_done;
+    wire [5:0] hash_perf;
+
+    wire push = start && ready;
+    wire issue = (q_count != 0) && hash_ready;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            q_wr <= 0;
+            q_rd <= 0;
+            q_count <= 0;
+            hash_index <= 64'd0;
+            dot_index <= 64'd0;
+            slot_active <= 1'b0;
+            tail_active <= 1'b0;
+        end
+        else begin
+            if (push) begin
+                q_index[q_wr] <= index;
+                q_wr <= q_wr + 1'd1;
+            end
+
+            if (issue) begin
+                q_rd <= q_rd + 1'd1;
+                hash_index <= q_index[q_rd];
+            end
+
+            if (push && !issue)
+                q_count <= q_count + 1'd1;
+            else if (issue && !push)
+                q_count <= q_count - 1'd1;
+
+            // Last element leaves the hash: slot moves to the dot product tail
+            if (valid && last)
+                dot_index <= hash_index;
+
+            if (issue)
+                slot_active <= 1'b1;
+            else if (valid && last)
+                slot_active <= 1'b0;
+
+            if (valid && last)
+                tail_active <= 1'b1;
+            else if (dot_done)
+                tail_active <= 1'b0;
+        end
+    end
 
     // Hash Module
     hash_to_vector #(
         .N_LWR(N_LWR),
         .N(N),
-        .ELEM_WIDTH(ELEM_WIDTH)
+        .ELEM_WIDTH(ELEM_WIDTH),
+        .ROUNDS_PER_CYCLE(ROUNDS_PER_CYCLE),
+        .ELEMS_PER_CYCLE(ELEMS_PER_CYCLE)
     ) hash_inst (
         .clk(clk),
         .rst_n(rst_n),
-        .start(start),
-        .nonce(nonce),
-        .index(index),
+        .nonce_data(nonce_data),
+        .nonce_keep(nonce_keep),
+        .nonce_valid(nonce_valid && nonce_ready),
+        .nonce_last(nonce_last),
+        .nonce_ready(hash_nonce_ready),
+        .nonce_loaded(hash_nonce_loaded),
+        .start(issue),
+        .ready(hash_ready),
+        .index(q_index[q_rd]),
         .hash_out(a_in),
         .hash_idx(idx),
+        .hash_mask(mask),
         .hash_valid(valid),
-        .hash_last(last)
+        .hash_last(last),
+        .perf_events(hash_perf)
     );
 
-    // Secret Key
-    secret_key #(
-        .N_LWR(N_LWR),
-        .KEY_FILE("secret_key.mem")
-    ) sk (
-        .addr(idx),
-        .key_bit(key_bit)
-    );
+    // Secret Keys
+    genvar k;
+    generate
+        for (k = 0; k < NUM_KEYS; k = k + 1) begin : key_store
+            secret_key #(
+                .N_LWR(N_LWR),
+                .KEY_FILE(k == 0 ? KEY_FILE : ""),
+                .LANES(ELEMS_PER_CYCLE),
+                .WORD_WIDTH(KEY_WORD_WIDTH)
+            ) sk (
+                .clk(clk),
+                .rst_n(rst_n),
+                .addr(idx),
+                .key_bits(key_bits[k*ELEMS_PER_CYCLE +: ELEMS_PER_CYCLE]),
+                .wr_en(key_wr_en && (NUM_KEYS == 1 || key_wr_key == k)),
+                .wr_addr(key_wr_addr),
+                .wr_data(key_wr_data),
+                .swap(key_swap),
+                .swap_ok(!slot_active || (valid && last)), // last key read of a slot is this cycle
+                .swap_pending(swap_pending[k])
+            );
+        end
+    endgenerate
 
     // Dot Product
-    dot_product #(
-        .N_LWR(N_LWR),
-        .ELEM_WIDTH(ELEM_WIDTH),
-        .ACC_WIDTH(ACC_WIDTH)
-    ) dp (
-        .clk(clk),
-        .rst_n(rst_n),
-        .start(start),
-        .a_in(a_in),
-        .a_valid(valid),
-        .a_last(last),
-        .key_bit(key_bit),
-        .dot_product(dot_prod),
-        .done(dot_done)
-    );
+    generate
+        if (DOT_IMPL == 1) begin : dot_bitplane
+            dot_product_bitplane #(
+                .N_LWR(N_LWR),
+                .ELEM_WIDTH(ELEM_WIDTH),
+                .ACC_WIDTH(ACC_WIDTH),
+                .LANES(ELEMS_PER_CYCLE),
+                .NUM_KEYS(NUM_KEYS)
+            ) dp (
+                .clk(clk),
+                .rst_n(rst_n),
+                .start(1'b0), // clears itself after a_last
+                .a_in(a_in),
+                .a_mask(mask),
+                .a_valid(valid),
+                .a_last(last),
+                .key_bits(key_bits),
+                .dot_product(dot_prods),
+                .done(dot_done)
+            );
+        end
+        else begin : dot_tree
+            dot_product #(
+                .N_LWR(N_LWR),
+                .ELEM_WIDTH(ELEM_WIDTH),
+                .ACC_WIDTH(ACC_WIDTH),
+                .LANES(ELEMS_PER_CYCLE),
+                .NUM_KEYS(NUM_KEYS)
+            ) dp (
+                .clk(clk),
+                .rst_n(rst_n),
+                .start(1'b0), // clears itself after a_last
+                .a_in(a_in),
+                .a_mask(mask),
+                .a_valid(valid),
+                .a_last(last),
+                .key_bits(key_bits),
+                .dot_product(dot_prods),
+                .done(dot_done)
+            );
+        end
+    endgenerate
 
-    prf_rounding #(
-        .N(N),
-        .P(P),
-        .ACC_WIDTH(ACC_WIDTH)
-    ) round (
-        .inner_product(dot_prod),
-        .prf_out(prf_out)
-    );
+    generate
+        for (k = 0; k < NUM_KEYS; k = k + 1) begin : key_out
+            prf_rounding #(
+                .N(N),
+                .P(P),
+                .ACC_WIDTH(ACC_WIDTH)
+            ) round (
+                .inner_product(dot_prods[k*ACC_WIDTH +: ACC_WIDTH]),
+                .prf_out(prf_out[k*OUT_WIDTH +: OUT_WIDTH])
+            );
+        end
+    endgenerate
 
+    // Queue only behind a loaded nonce; nonce beats wait for an empty queue
+    assign ready = (q_count != QUEUE_DEPTH) && hash_nonce_loaded;
+    assign nonce_ready = hash_nonce_ready && (q_count == 0) && !push;
+    assign prf_index = dot_index;
+    assign key_swap_pending = swap_pending[0]; // all keys swap together
     assign done = dot_done;
-    
-    
+
+    wire in_flight = (q_count != 0) || slot_active || tail_active;
+    assign perf_events = {in_flight && !valid, in_flight, dot_done, valid, hash_perf};
+
+    perf_counters #(
+        .NUM_EVENTS(10),
+        .ADDR_WIDTH(5)
+    ) perf (
+        .clk(clk),
+        .rst_n(rst_n),
+        .events(perf_events),
+        .csr_addr(perf_addr),
+        .csr_wr_en(perf_wr_en),
+        .csr_wr_data(perf_wr_data),
+        .csr_rd_en(perf_rd_en),
+        .csr_rd_data(perf_rd_data),
+        .csr_rd_valid(perf_rd_valid)
+    );
 
 endmodule
\ No newline at end of file
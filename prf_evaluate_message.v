@@ -0,0 +1,90 @@
+module prf_evaluate_message #(
+    parameter N_LWR = 445,
+    parameter N = 2048,
+    parameter P = 32,
+    parameter ROUNDS_PER_CYCLE = 1, // keccak_f1600 rounds per clock
+    parameter ELEMS_PER_CYCLE = 1   // hash elements per dot product beat
+) (
+    input wire clk,
+    input wire rst_n,
+
+    input wire start,
+    output wire ready,
+
+    input wire [63:0] nonce_data,
+    input wire [7:0] nonce_keep,
+    input wire nonce_valid,
+    input wire nonce_last,
+    output wire nonce_ready,
+
+    input wire [63:0] index,
+
+    input wire key_wr_en,
+    input wire [$clog2(N_LWR)-1:0] key_wr_addr,
+    input wire [31:0] key_wr_data,
+    input wire key_swap,
+    output wire key_swap_pending,
+
+    input wire [$clog2(P)-1:0] plaintext,
+
+    output wire [$clog2(P)-1:0] prf_out,
+    output wire [$clog2(P)-1:0] ciphertext,
+    output wire [63:0] prf_index,
+    output wire done,
+
+    // Performance counters of the PRF (see prf_evaluate)
+    input wire [4:0] perf_addr,
+    input wire perf_wr_en,
+    input wire [31:0] perf_wr_data,
+    input wire perf_rd_en,
+    output wire [31:0] perf_rd_data,
+    output wire perf_rd_valid
+);
+
+    // PRF
+    prf_evaluate #(
+        .N_LWR(N_LWR),
+        .N(N),
+        .P(P),
+        .ROUNDS_PER_CYCLE(ROUNDS_PER_CYCLE),
+        .ELEMS_PER_CYCLE(ELEMS_PER_CYCLE)
+    ) prf (
+        .clk(clk),
+        .rst_n(rst_n),
+        .start(start),
+        .ready(ready),
+        .nonce_data(nonce_data),
+        .nonce_keep(nonce_keep),
+        .nonce_valid(nonce_valid),
+        .nonce_last(nonce_last),
+        .nonce_ready(nonce_ready),
+        .index(index),
+        .key_wr_en(key_wr_en),
+        .key_wr_key(1'b0),
+        .key_wr_addr(key_wr_addr),
+        .key_wr_data(key_wr_data),
+        .key_swap(key_swap),
+        .key_swap_pending(key_swap_pending),
+        .prf_out(prf_out),
+        .prf_index(prf_index),
+        .done(done),
+        .perf_events(),
+        .perf_addr(perf_addr),
+        .perf_wr_en(perf_wr_en),
+        .perf_wr_data(perf_wr_data),
+        .perf_rd_en(perf_rd_en),
+        .perf_rd_data(perf_rd_data),
+        .perf_rd_valid(perf_rd_valid)
+    );
+
+    // Encrypt the symbol with the PRF output of its slot; plaintext is the
+    // symbol of the slot completing (prf_index) when done is high
+    encrypt #(
+        .P(P)
+    ) enc (
+        .plaintext(plaintext),
+        .prf_out(prf_out),
+        .ciphertext(ciphertext)
+    );
+
+endmodule
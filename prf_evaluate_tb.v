@@ -1,34 +1,96 @@
 `timescale 1ns / 1ps
 
-module prf_evaluate_tb;
+module prf_evaluate_tb #(
+    // Override to check wide beats and the dot_product adder tree behind
+    // them (golden values are the same), e.g.
+    //   iverilog -P prf_evaluate_tb.ELEMS_PER_CYCLE=4 ...
+    //   iverilog -P prf_evaluate_tb.ELEMS_PER_CYCLE=17 ...
+    // NUM_KEYS=2 adds Test Case 10 (a second key store and output lane).
+    // DOT_IMPL=1 checks dot_product_bitplane; run it at ELEMS_PER_CYCLE=1
+    // and 4 (flush groups that do not line up with rate blocks).
+    parameter ELEMS_PER_CYCLE = 1,
+    parameter NUM_KEYS = 1,
+    parameter DOT_IMPL = 0
+);
     // Parameters
     localparam N_LWR = 445;
     localparam N = 2048;
     localparam P = 32;
     localparam CLK_PERIOD = 10; // 10ns = 100MHz
+    localparam ACC_WIDTH = $clog2(N) + 1; // as in prf_evaluate
+    // Beats per vector: every 17-element rate block is split into beats of
+    // up to ELEMS_PER_CYCLE elements, the last block holds N_LWR % 17
+    localparam BLOCK_BEATS = (17 + ELEMS_PER_CYCLE - 1) / ELEMS_PER_CYCLE;
+    localparam VECTOR_BEATS = (N_LWR / 17) * BLOCK_BEATS +
+                              ((N_LWR % 17) + ELEMS_PER_CYCLE - 1) / ELEMS_PER_CYCLE;
+    localparam [63:0] TEST_NONCE = 64'h646565735f72776c; // "lwr_seed", first byte in [7:0]
+    localparam [71:0] SOME_SEED = "some_seed";           // first byte in [71:64]
 
     // Signals
     reg clk;
     reg rst_n;
     reg start;
-    reg [63:0] nonce;
+    reg [63:0] nonce_data;
+    reg [7:0] nonce_keep;
+    reg nonce_valid;
+    reg nonce_last;
+    wire nonce_ready;
     reg [63:0] index;
-    wire [4:0] prf_out;  // $clog2(32) = 5 bits
+    reg key_wr_en;
+    reg key_wr_key;
+    reg [8:0] key_wr_addr;
+    reg [31:0] key_wr_data;
+    reg key_swap;
+    wire key_swap_pending;
+    wire [NUM_KEYS*5-1:0] prf_outs;
+    wire [4:0] prf_out = prf_outs[4:0]; // key 0, $clog2(32) = 5 bits
+    wire [9:0] prf_pair = prf_outs;     // keys 0 and 1, zero-extended
+    wire [63:0] prf_index;
+    wire ready;
     wire done;
+    wire [9:0] perf_events;
+    reg [4:0] csr_addr;
+    reg csr_wr_en;
+    reg [31:0] csr_wr_data;
+    reg csr_rd_en;
+    wire [31:0] csr_rd_data;
+    wire csr_rd_valid;
 
     // Instantiate DUT (Device Under Test)
     prf_evaluate #(
         .N_LWR(N_LWR),
         .N(N),
-        .P(P)
+        .P(P),
+        .ELEMS_PER_CYCLE(ELEMS_PER_CYCLE),
+        .NUM_KEYS(NUM_KEYS),
+        .DOT_IMPL(DOT_IMPL)
     ) dut (
         .clk(clk),
         .rst_n(rst_n),
         .start(start),
-        .nonce(nonce),
+        .ready(ready),
+        .nonce_data(nonce_data),
+        .nonce_keep(nonce_keep),
+        .nonce_valid(nonce_valid),
+        .nonce_last(nonce_last),
+        .nonce_ready(nonce_ready),
         .index(index),
-        .prf_out(prf_out),
-        .done(done)
+        .key_wr_en(key_wr_en),
+        .key_wr_key(key_wr_key),
+        .key_wr_addr(key_wr_addr),
+        .key_wr_data(key_wr_data),
+        .key_swap(key_swap),
+        .key_swap_pending(key_swap_pending),
+        .prf_out(prf_outs),
+        .prf_index(prf_index),
+        .done(done),
+        .perf_events(perf_events),
+        .perf_addr(csr_addr),
+        .perf_wr_en(csr_wr_en),
+        .perf_wr_data(csr_wr_data),
+        .perf_rd_en(csr_rd_en),
+        .perf_rd_data(csr_rd_data),
+        .perf_rd_valid(csr_rd_valid)
     );
 
     // Clock generation
@@ -39,6 +101,7 @@ module prf_evaluate_tb;
 
     // Cycle counter for debugging
     integer cycle_count;
+    integer hash_errors;
     always @(posedge clk) begin
         if (!rst_n)
             cycle_count <= 0;
@@ -46,13 +109,138 @@ module prf_evaluate_tb;
             cycle_count <= cycle_count + 1;
     end
 
+    // Expected element stream for index 0 (generate_test_vectors.py)
+    reg [11:0] expected_hash [0:N_LWR-1];
+    reg check_hash; // the "lwr_seed" nonce is loaded
+
+    // Nonce bytes streamed by send_nonce
+    reg [7:0] nonce_bytes [0:255];
+    integer i;
+
+    // Stream nonce_bytes[0:len-1] in 8-byte beats
+    task send_nonce;
+        input integer len;
+        integer sent;
+        integer take;
+        integer b;
+        reg accepted_last;
+        begin
+            sent = 0;
+            accepted_last = 0;
+            while (!accepted_last) begin
+                take = (len - sent < 8) ? len - sent : 8;
+                for (b = 0; b < 8; b = b + 1) begin
+                    nonce_data[b*8 +: 8] = (b < take) ? nonce_bytes[sent + b] : 8'h00;
+                    nonce_keep[b] = (b < take);
+                end
+                nonce_last = (sent + take == len);
+                nonce_valid = 1;
+                if (nonce_ready) begin
+                    sent = sent + take;
+                    accepted_last = nonce_last;
+                end
+                #CLK_PERIOD;
+            end
+            nonce_valid = 0;
+        end
+    endtask
+
+    // Evaluate one slot and compare prf_out
+    task check_slot;
+        input [63:0] slot;
+        input [4:0] expected;
+        begin
+            index = slot;
+            start = 1;
+            #CLK_PERIOD;
+            start = 0;
+
+            wait(done);
+            if (prf_out == expected)
+                $display("    ✓ PASS: slot %0d -> %0d", slot, prf_out);
+            else
+                $display("    ✗ FAIL: Expected slot %0d -> %0d, got %0d", slot, expected, prf_out);
+            #CLK_PERIOD;
+        end
+    endtask
+
+    // Register access to the DUT's perf_counters
+    task csr_write;
+        input [4:0] addr;
+        input [31:0] data;
+        begin
+            csr_addr = addr;
+            csr_wr_data = data;
+            csr_wr_en = 1;
+            #CLK_PERIOD;
+            csr_wr_en = 0;
+        end
+    endtask
+
+    task csr_read;
+        input [4:0] addr;
+        output [31:0] data;
+        begin
+            csr_addr = addr;
+            csr_rd_en = 1;
+            #CLK_PERIOD;
+            csr_rd_en = 0;
+            data = csr_rd_data;
+        end
+    endtask
+
+    // Key 0 as loaded from secret_key.mem, written to key 1 in Test Case 10
+    reg key_file_bits [0:N_LWR-1];
+    reg [31:0] key_word;
+    integer j;
+
+    // Evaluate one slot and compare both key lanes (NUM_KEYS > 1)
+    task check_slot_keys;
+        input [63:0] slot;
+        input [4:0] expected0;
+        input [4:0] expected1;
+        begin
+            index = slot;
+            start = 1;
+            #CLK_PERIOD;
+            start = 0;
+
+            wait(done);
+            if (prf_pair[4:0] == expected0 && prf_pair[9:5] == expected1)
+                $display("    ✓ PASS: slot %0d -> key 0: %0d, key 1: %0d", slot, prf_pair[4:0], prf_pair[9:5]);
+            else
+                $display("    ✗ FAIL: Expected slot %0d -> %0d/%0d, got %0d/%0d",
+                         slot, expected0, expected1, prf_pair[4:0], prf_pair[9:5]);
+            #CLK_PERIOD;
+        end
+    endtask
+
+    // Counter values read back in Test Case 9 (event e at csr address 1 + e)
+    reg [31:0] perf_value [0:9];
+
     // Test stimulus
     initial begin
+        $readmemh("hash_vector.mem", expected_hash);
+        hash_errors = 0;
+
         // Initialize signals
         rst_n = 0;
         start = 0;
-        nonce = 64'h0;
+        nonce_data = 64'h0;
+        nonce_keep = 8'h0;
+        nonce_valid = 0;
+        nonce_last = 0;
         index = 64'h0;
+        key_wr_en = 0;
+        key_wr_key = 0;
+        key_wr_addr = 9'd0;
+        key_wr_data = 32'd0;
+        key_swap = 0;
+        check_hash = 0;
+        csr_addr = 5'd0;
+        csr_wr_en = 0;
+        csr_wr_data = 32'd0;
+        csr_rd_en = 0;
 
         // Dump waveforms for viewing
         $dumpfile("prf_evaluate_tb.vcd");
@@ -70,12 +258,29 @@ module prf_evaluate_tb;
         rst_n = 1;
         #(CLK_PERIOD);
 
+        // Test Case 0: a request before any nonce is refused, so the nonce
+        // that follows is still taken
+        $display("Test Case 0: start before the nonce");
+        start = 1;
+        #(CLK_PERIOD * 3);
+        start = 0;
+        if (!ready && dut.q_count == 0)
+            $display("    ✓ PASS: request refused until a nonce is loaded");
+        else
+            $display("    ✗ FAIL: request queued without a nonce (q_count=%0d)", dut.q_count);
+        $display("");
+
         // Test Case 1: Basic PRF evaluation
         $display("Test Case 1: PRF Evaluation");
-        $display("  Nonce: 0x%016h", nonce);
+        $display("  Nonce: 0x%016h", TEST_NONCE);
         $display("  Index: 0x%016h", index);
         $display("");
 
+        for (i = 0; i < 8; i = i + 1)
+            nonce_bytes[i] = TEST_NONCE[i*8 +: 8];
+        send_nonce(8);
+        check_hash = 1;
+
         // Start PRF evaluation
         start = 1;
         #CLK_PERIOD;
@@ -92,11 +297,15 @@ module prf_evaluate_tb;
 
         // Compare with expected value from Python
         $display("  Verification:");
-        if (prf_out == 16) begin
-            $display("    ✓ PASS: PRF output matches expected value (16)");
+        if (prf_out == 8) begin
+            $display("    ✓ PASS: PRF output matches expected value (8)");
         end else begin
-            $display("    ✗ FAIL: Expected 16, got %0d", prf_out);
+            $display("    ✗ FAIL: Expected 8, got %0d", prf_out);
         end
+        if (hash_errors == 0)
+            $display("    ✓ PASS: Hash vector matches hash_vector.mem");
+        else
+            $display("    ✗ FAIL: %0d hash element(s) differ from hash_vector.mem", hash_errors);
         $display("");
 
         // Test Case 2: Another evaluation with same inputs (should get same result)
@@ -112,6 +321,170 @@ module prf_evaluate_tb;
         $display("  PRF Output: %0d (should match Test Case 1)", prf_out);
         $display("");
 
+        // Test Case 3: Next slot (index 1)
+        $display("Test Case 3: PRF Evaluation, index 1");
+        #(CLK_PERIOD * 5);
+        index = 64'h1;
+        start = 1;
+        #CLK_PERIOD;
+        start = 0;
+
+        wait(done);
+        #CLK_PERIOD;
+
+        if (prf_out == 29)
+            $display("    ✓ PASS: PRF output matches expected value (29)");
+        else
+            $display("    ✗ FAIL: Expected 29, got %0d", prf_out);
+        $display("");
+
+        // Test Case 4: Back-to-back requests (queued, results in order)
+        $display("Test Case 4: Back-to-back requests, index 1 then 0");
+        #(CLK_PERIOD * 5);
+        index = 64'h1;
+        start = 1;
+        #CLK_PERIOD;
+        index = 64'h0;
+        #CLK_PERIOD;
+        start = 0;
+
+        wait(done);
+        if (prf_index == 1 && prf_out == 29)
+            $display("    ✓ PASS: slot 1 -> %0d", prf_out);
+        else
+            $display("    ✗ FAIL: Expected slot 1 -> 29, got slot %0d -> %0d", prf_index, prf_out);
+        #CLK_PERIOD;
+
+        wait(done);
+        if (prf_index == 0 && prf_out == 8)
+            $display("    ✓ PASS: slot 0 -> %0d", prf_out);
+        else
+            $display("    ✗ FAIL: Expected slot 0 -> 8, got slot %0d -> %0d", prf_index, prf_out);
+        #CLK_PERIOD;
+        $display("");
+
+        // Test Case 5: 9-byte nonce, index after the first lane
+        $display("Test Case 5: Nonce \"some_seed\" (9 bytes)");
+        check_hash = 0;
+        for (i = 0; i < 9; i = i + 1)
+            nonce_bytes[i] = SOME_SEED[(8-i)*8 +: 8];
+        send_nonce(9);
+        check_slot(64'd0, 5'd12);
+        $display("");
+
+        // Test Case 6: index running past the end of the first rate block
+        $display("Test Case 6: Nonce bytes 0..127 and 0..129 (index straddles the block)");
+        for (i = 0; i < 256; i = i + 1)
+            nonce_bytes[i] = i;
+        send_nonce(128);
+        check_slot(64'd0, 5'd7);
+        send_nonce(130);
+        check_slot(64'd0, 5'd13);
+        check_slot(64'd1, 5'd17);
+        $display("");
+
+        // Test Case 7: a full nonce block absorbed once as the midstate
+        $display("Test Case 7: Nonce bytes 0..139 (one block + 4-byte tail)");
+        send_nonce(140);
+        check_slot(64'd0, 5'd23);
+        check_slot(64'd1, 5'd4);
+        $display("");
+
+        // Test Case 8: key rotation through the shadow bank
+        $display("Test Case 8: Swap in an all-zero key, then swap back");
+        for (i = 0; i < (N_LWR + 31) / 32; i = i + 1) begin
+            key_wr_en = 1;
+            key_wr_addr = i;
+            key_wr_data = 32'd0;
+            #CLK_PERIOD;
+        end
+        key_wr_en = 0;
+        key_swap = 1;
+        #CLK_PERIOD;
+        key_swap = 0;
+        check_slot(64'd0, 5'd0);
+        key_swap = 1;
+        #CLK_PERIOD;
+        key_swap = 0;
+        check_slot(64'd0, 5'd23);
+        $display("");
+
+        // Test Case 9: performance counters over one slot
+        $display("Test Case 9: Performance counters over one slot");
+        @(negedge clk); // CSR accesses between clock edges
+        csr_write(5'd0, 32'h3); // clear all, keep counting
+        check_slot(64'd0, 5'd23);
+        @(negedge clk);
+        csr_write(5'd0, 32'h0); // freeze
+        for (i = 0; i < 10; i = i + 1)
+            csr_read(i + 1, perf_value[i]);
+        $display("    Keccak busy:      %0d cycles", perf_value[0]);
+        $display("    Permutations:     %0d", perf_value[1]);
+        $display("    shake256 busy:    %0d cycles", perf_value[2]);
+        $display("    Absorb stalls:    %0d cycles (data_in_valid low)", perf_value[3]);
+        $display("    Squeeze stalls:   %0d cycles (data_out_ready low)", perf_value[4]);
+        $display("    hash busy:        %0d cycles", perf_value[5]);
+        $display("    Dot input beats:  %0d", perf_value[6]);
+        $display("    Slots:            %0d", perf_value[7]);
+        $display("    Start to done:    %0d cycles, %0d without an element", perf_value[8], perf_value[9]);
+        if (perf_value[8] != 0)
+            $display("    Keccak utilization: %0d%%", perf_value[0] * 100 / perf_value[8]);
+        if (perf_value[1] == (N_LWR + 16) / 17)
+            $display("    ✓ PASS: %0d permutations (one per rate block)", perf_value[1]);
+        else
+            $display("    ✗ FAIL: expected %0d permutations, got %0d", (N_LWR + 16) / 17, perf_value[1]);
+        // Slots load their padded block whole, so the absorb never waits
+        if (perf_value[3] == 0)
+            $display("    ✓ PASS: no absorb stalls");
+        else
+            $display("    ✗ FAIL: %0d absorb stall cycles without an open message", perf_value[3]);
+        if (perf_value[7] == 1 && perf_value[6] == VECTOR_BEATS && perf_value[8] == perf_value[6] + perf_value[9])
+            $display("    ✓ PASS: one slot, %0d element beats", VECTOR_BEATS);
+        else
+            $display("    ✗ FAIL: expected 1 slot and %0d element beats", VECTOR_BEATS);
+        csr_write(5'd0, 32'h1);
+        $display("");
+
+        // Test Case 10: a second key, written through key_wr_key. Key 1 has
+        // no KEY_FILE, so it starts all zero; key 0's shadow bank still
+        // holds the all-zero key of Test Case 8.
+        if (NUM_KEYS > 1) begin
+            $display("Test Case 10: Second key store (NUM_KEYS=%0d)", NUM_KEYS);
+            $readmemb("secret_key.mem", key_file_bits);
+            @(negedge clk);
+            check_slot_keys(64'd0, 5'd23, 5'd0);
+            @(negedge clk);
+            for (i = 0; i < (N_LWR + 31) / 32; i = i + 1) begin
+                for (j = 0; j < 32; j = j + 1)
+                    key_word[j] = (i * 32 + j < N_LWR) ? key_file_bits[i * 32 + j] : 1'b0;
+                key_wr_en = 1;
+                key_wr_key = 1;
+                key_wr_addr = i;
+                key_wr_data = key_word;
+                #CLK_PERIOD;
+            end
+            key_wr_en = 0;
+            key_wr_key = 0;
+            key_swap = 1;
+            #CLK_PERIOD;
+            key_swap = 0;
+            check_slot_keys(64'd0, 5'd0, 5'd23);
+            @(negedge clk);
+            key_swap = 1;
+            #CLK_PERIOD;
+            key_swap = 0;
+            check_slot_keys(64'd0, 5'd23, 5'd0);
+            $display("");
+        end
+
+        // Beat structure of every slot streamed above
+        $display("Hash stream (all slots, ELEMS_PER_CYCLE=%0d):", ELEMS_PER_CYCLE);
+        if (hash_errors == 0)
+            $display("    ✓ PASS: contiguous beats, masks and element N_LWR-1 on hash_last");
+        else
+            $display("    ✗ FAIL: %0d beat or element error(s)", hash_errors);
+        $display("");
+
         // End simulation
         $display("================================================================================");
         $display("Simulation Complete");
@@ -120,48 +493,75 @@ module prf_evaluate_tb;
         $finish;
     end
 
-    // Monitor internal signals for debugging
+    // Monitor internal signals for debugging. Every beat must continue at
+    // the element after the previous one, carry a mask contiguous from bit
+    // 0, and the vector must end with hash_last on element N_LWR-1.
+    integer hash_next; // element expected at hash_idx
+    integer lane;
+    reg mask_gap;
     always @(posedge clk) begin
-        if (dut.hash_inst.hash_valid) begin
-            $display("[Cycle %0d] Hash streaming: idx=%0d, value=0x%03h",
-                     cycle_count, dut.hash_inst.hash_idx, dut.hash_inst.hash_out);
+        if (!rst_n)
+            hash_next = 0;
+        else if (dut.hash_inst.hash_valid) begin
+            $display("[Cycle %0d] Hash streaming: idx=%0d, mask=%b, value=0x%h",
+                     cycle_count, dut.hash_inst.hash_idx, dut.hash_inst.hash_mask, dut.hash_inst.hash_out);
+            if (dut.hash_inst.hash_idx != hash_next || dut.hash_inst.hash_mask[0] !== 1'b1)
+                hash_errors = hash_errors + 1;
+            mask_gap = 0;
+            for (lane = 0; lane < ELEMS_PER_CYCLE; lane = lane + 1) begin
+                if (dut.hash_inst.hash_mask[lane]) begin
+                    if (mask_gap)
+                        hash_errors = hash_errors + 1;
+                    if (check_hash && dut.hash_index == 0 &&
+                        dut.hash_inst.hash_out[lane*12 +: 12] !== expected_hash[dut.hash_inst.hash_idx + lane])
+                        hash_errors = hash_errors + 1;
+                    hash_next = hash_next + 1;
+                end
+                else
+                    mask_gap = 1;
+            end
+            if (dut.hash_inst.hash_last) begin
+                if (hash_next != N_LWR)
+                    hash_errors = hash_errors + 1;
+                hash_next = 0;
+            end
         end
     end
 
-    // Display dot product result when done
+    // Display dot product result when done (index 0 expectations)
     always @(posedge clk) begin
-        if (dut.dp.done) begin
+        if (dut.dot_done && prf_index == 0 && check_hash) begin
             $display("");
             $display("  Intermediate values:");
-            $display("    Dot product:     %0d (expected: 480267)", dut.dot_prod);
-            $display("    Inner mod 2N:    %0d (expected: 1035)", dut.round.inner_mod_2N);
-            $display("    Inner mod N:     %0d (expected: 1035)", dut.round.inner_mod_N);
-            $display("    MSB:             %0d (expected: 0)", dut.round.msb);
-            $display("    Rounded:         %0d (expected: 16)", dut.round.rounded);
-            $display("    PRF output:      %0d (expected: 16)", prf_out);
+            $display("    Dot product:     %0d (expected: 455170 mod 2N = 514)", dut.dot_prods[ACC_WIDTH-1:0]);
+            $display("    Inner mod 2N:    %0d (expected: 514)", dut.key_out[0].round.inner_mod_2N);
+            $display("    Inner mod N:     %0d (expected: 514)", dut.key_out[0].round.inner_mod_N);
+            $display("    MSB:             %0d (expected: 0)", dut.key_out[0].round.msb);
+            $display("    Rounded:         %0d (expected: 8)", dut.key_out[0].round.rounded);
+            $display("    PRF output:      %0d (expected: 8)", prf_out);
 
             // Verify intermediate values
             $display("");
             $display("  Intermediate value checks:");
-            if (dut.dot_prod == 480267)
+            if (dut.dot_prods[ACC_WIDTH-1:0] == 514)
                 $display("    ✓ Dot product correct");
             else
-                $display("    ✗ Dot product FAILED: expected 480267, got %0d", dut.dot_prod);
+                $display("    ✗ Dot product FAILED: expected 514, got %0d", dut.dot_prods[ACC_WIDTH-1:0]);
 
-            if (dut.round.inner_mod_2N == 1035)
+            if (dut.key_out[0].round.inner_mod_2N == 514)
                 $display("    ✓ Inner mod 2N correct");
             else
-                $display("    ✗ Inner mod 2N FAILED: expected 1035, got %0d", dut.round.inner_mod_2N);
+                $display("    ✗ Inner mod 2N FAILED: expected 514, got %0d", dut.key_out[0].round.inner_mod_2N);
 
-            if (dut.round.msb == 0)
+            if (dut.key_out[0].round.msb == 0)
                 $display("    ✓ MSB correct");
             else
-                $display("    ✗ MSB FAILED: expected 0, got %0d", dut.round.msb);
+                $display("    ✗ MSB FAILED: expected 0, got %0d", dut.key_out[0].round.msb);
 
-            if (dut.round.rounded == 16)
+            if (dut.key_out[0].round.rounded == 8)
                 $display("    ✓ Rounded value correct");
             else
-                $display("    ✗ Rounded FAILED: expected 16, got %0d", dut.round.rounded);
+                $display("    ✗ Rounded FAILED: expected 8, got %0d", dut.key_out[0].round.rounded);
 
             $display("");
         end
@@ -169,7 +569,7 @@ module prf_evaluate_tb;
 
     // Timeout watchdog
     initial begin
-        #(CLK_PERIOD * 10000); // 10000 cycles timeout
+        #(CLK_PERIOD * 25000); // 25000 cycles timeout
         $display("ERROR: Simulation timeout!");
         $finish;
     end
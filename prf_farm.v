@@ -0,0 +1,260 @@
+// CORES prf_evaluate instances behind one prf_evaluate-style interface.
+// Each request goes to a free core (rotating priority from the core after
+// the last one used, so equal-latency cores are filled round-robin) and is
+// tagged with its position in request order. Results land in a reorder
+// buffer under that tag and done pulses in request order, one slot per
+// cycle at most, so slots/s scales with CORES while the output stream is
+// the same as a single prf_evaluate's.
+//
+// The nonce and key writes go to every core; nonce_ready is high only
+// when all cores can take the beat. Each core applies key_swap between
+// its own slots as in prf_evaluate.
+//
+// The cores' own counter ports are left idle: one perf_counter_bank
+// counts every core's perf_events (see prf_evaluate), and perf_core
+// selects the core the perf_* register access goes to.
+module prf_farm #(
+    parameter N_LWR = 445,
+    parameter N = 2048,
+    parameter P = 32,
+    parameter ROUNDS_PER_CYCLE = 1, // keccak_f1600 rounds per clock
+    parameter ELEMS_PER_CYCLE = 1,  // hash elements squeezed and summed per beat (1-17)
+    parameter KEY_FILE = "secret_key.mem", // initial key, "" for none
+    parameter KEY_WORD_WIDTH = 32,  // key store word, power of 2 (>= ELEMS_PER_CYCLE)
+    parameter NUM_KEYS = 1,         // keys evaluated per slot
+    parameter DOT_IMPL = 0,         // 0: adder tree (dot_product), 1: bit-plane popcount
+    parameter CORES = 4,            // prf_evaluate instances
+    parameter CORE_DEPTH = 4        // slots outstanding per core, power of 2 (>= 2)
+) (
+    input wire clk,
+    input wire rst_n,
+
+    input wire start,
+    output wire ready,              // a core and a reorder buffer entry are free
+
+    input wire [63:0] nonce_data,
+    input wire [7:0] nonce_keep,
+    input wire nonce_valid,
+    input wire nonce_last,
+    output wire nonce_ready,
+
+    input wire [63:0] index,
+
+    // Key store (see prf_evaluate), written to every core
+    input wire key_wr_en,
+    input wire [((NUM_KEYS > 1) ? $clog2(NUM_KEYS) : 1)-1:0] key_wr_key,
+    input wire [$clog2(N_LWR)-1:0] key_wr_addr,
+    input wire [KEY_WORD_WIDTH-1:0] key_wr_data,
+    input wire key_swap,
+    output wire key_swap_pending,
+
+    output wire [NUM_KEYS*$clog2(P)-1:0] prf_out,
+    output wire [63:0] prf_index,
+    output wire done,
+
+    // Performance counters of core perf_core (see prf_evaluate)
+    input wire [((CORES > 1) ? $clog2(CORES) : 1)-1:0] perf_core,
+    input wire [4:0] perf_addr,
+    input wire perf_wr_en,
+    input wire [31:0] perf_wr_data,
+    input wire perf_rd_en,
+    output wire [31:0] perf_rd_data,
+    output wire perf_rd_valid
+);
+
+    localparam OUT_WIDTH = NUM_KEYS * $clog2(P);
+    localparam CPTR_WIDTH = (CORES > 1) ? $clog2(CORES) : 1;
+    localparam TPTR_WIDTH = $clog2(CORE_DEPTH);
+    // Every slot a core can hold, plus results waiting behind a slower slot
+    localparam ROB_DEPTH = 2 << $clog2(CORES * CORE_DEPTH);
+    localparam RPTR_WIDTH = $clog2(ROB_DEPTH);
+
+    // Per-core status, packed by core
+    wire [CORES-1:0] core_free;
+    wire [CORES-1:0] core_nonce_ready;
+    wire [CORES-1:0] core_swap_pending;
+    wire [CORES-1:0] core_done;
+    wire [CORES*OUT_WIDTH-1:0] core_out;
+    wire [CORES*64-1:0] core_index;
+    wire [CORES*RPTR_WIDTH-1:0] core_tag;
+    wire [CORES*10-1:0] core_perf;
+
+    // Dispatcher: first free core at or after rr
+    reg [CPTR_WIDTH-1:0] rr;
+    reg [CPTR_WIDTH-1:0] sel;
+    reg sel_valid;
+    integer c, cc;
+    always @(*) begin
+        sel = rr;
+        sel_valid = 1'b0;
+        for (c = CORES - 1; c >= 0; c = c - 1) begin
+            cc = (rr + c) % CORES;
+            if (core_free[cc]) begin
+                sel = cc;
+                sel_valid = 1'b1;
+            end
+        end
+    end
+
+    // Reorder buffer, indexed by request tag
+    reg [OUT_WIDTH-1:0] rob_out [0:ROB_DEPTH-1];
+    reg [63:0] rob_index [0:ROB_DEPTH-1];
+    reg [ROB_DEPTH-1:0] rob_valid;
+    reg [RPTR_WIDTH-1:0] rob_wr; // tag of the next request
+    reg [RPTR_WIDTH-1:0] rob_rd; // tag of the next result out
+    reg [RPTR_WIDTH:0] rob_count;
+
+    reg [OUT_WIDTH-1:0] out_reg;
+    reg [63:0] out_index;
+    reg out_done;
+
+    wire dispatch = start && ready;
+    integer w;
+    wire emit = rob_valid[rob_rd];
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            rr <= 0;
+            rob_valid <= {ROB_DEPTH{1'b0}};
+            rob_wr <= 0;
+            rob_rd <= 0;
+            rob_count <= 0;
+            out_reg <= {OUT_WIDTH{1'b0}};
+            out_index <= 64'd0;
+            out_done <= 1'b0;
+        end
+        else begin
+            if (dispatch) begin
+                rr <= (sel == CORES - 1) ? 0 : sel + 1'd1;
+                rob_wr <= rob_wr + 1'd1;
+            end
+
+            if (emit) begin
+                out_reg <= rob_out[rob_rd];
+                out_index <= rob_index[rob_rd];
+                rob_valid[rob_rd] <= 1'b0;
+                rob_rd <= rob_rd + 1'd1;
+            end
+            out_done <= emit;
+
+            // A tag is reused only after its result has been emitted
+            for (w = 0; w < CORES; w = w + 1) begin
+                if (core_done[w]) begin
+                    rob_out[core_tag[w*RPTR_WIDTH +: RPTR_WIDTH]] <= core_out[w*OUT_WIDTH +: OUT_WIDTH];
+                    rob_index[core_tag[w*RPTR_WIDTH +: RPTR_WIDTH]] <= core_index[w*64 +: 64];
+                    rob_valid[core_tag[w*RPTR_WIDTH +: RPTR_WIDTH]] <= 1'b1;
+                end
+            end
+
+            if (dispatch && !emit)
+                rob_count <= rob_count + 1'd1;
+            else if (emit && !dispatch)
+                rob_count <= rob_count - 1'd1;
+        end
+    end
+
+    wire all_nonce_ready = &core_nonce_ready;
+
+    genvar g;
+    generate
+        for (g = 0; g < CORES; g = g + 1) begin : core
+            wire prf_ready;
+            wire take = dispatch && (sel == g);
+
+            // Tags of this core's outstanding slots; a core finishes its
+            // slots in the order it was given them
+            reg [RPTR_WIDTH-1:0] tags [0:CORE_DEPTH-1];
+            reg [TPTR_WIDTH-1:0] tag_wr;
+            reg [TPTR_WIDTH-1:0] tag_rd;
+            reg [TPTR_WIDTH:0] outstanding;
+
+            always @(posedge clk or negedge rst_n) begin
+                if (!rst_n) begin
+                    tag_wr <= 0;
+                    tag_rd <= 0;
+                    outstanding <= 0;
+                end
+                else begin
+                    if (take) begin
+                        tags[tag_wr] <= rob_wr;
+                        tag_wr <= tag_wr + 1'd1;
+                    end
+                    if (core_done[g])
+                        tag_rd <= tag_rd + 1'd1;
+
+                    if (take && !core_done[g])
+                        outstanding <= outstanding + 1'd1;
+                    else if (core_done[g] && !take)
+                        outstanding <= outstanding - 1'd1;
+                end
+            end
+
+            assign core_free[g] = prf_ready && (outstanding != CORE_DEPTH);
+            assign core_tag[g*RPTR_WIDTH +: RPTR_WIDTH] = tags[tag_rd];
+
+            prf_evaluate #(
+                .N_LWR(N_LWR),
+                .N(N),
+                .P(P),
+                .ROUNDS_PER_CYCLE(ROUNDS_PER_CYCLE),
+                .ELEMS_PER_CYCLE(ELEMS_PER_CYCLE),
+                .KEY_FILE(KEY_FILE),
+                .KEY_WORD_WIDTH(KEY_WORD_WIDTH),
+                .NUM_KEYS(NUM_KEYS),
+                .DOT_IMPL(DOT_IMPL)
+            ) prf (
+                .clk(clk),
+                .rst_n(rst_n),
+                .start(take),
+                .ready(prf_ready),
+                .nonce_data(nonce_data),
+                .nonce_keep(nonce_keep),
+                .nonce_valid(nonce_valid && all_nonce_ready),
+                .nonce_last(nonce_last),
+                .nonce_ready(core_nonce_ready[g]),
+                .index(index),
+                .key_wr_en(key_wr_en),
+                .key_wr_key(key_wr_key),
+                .key_wr_addr(key_wr_addr),
+                .key_wr_data(key_wr_data),
+                .key_swap(key_swap),
+                .key_swap_pending(core_swap_pending[g]),
+                .prf_out(core_out[g*OUT_WIDTH +: OUT_WIDTH]),
+                .prf_index(core_index[g*64 +: 64]),
+                .done(core_done[g]),
+                .perf_events(core_perf[g*10 +: 10]),
+                .perf_addr(5'd0),
+                .perf_wr_en(1'b0),
+                .perf_wr_data(32'd0),
+                .perf_rd_en(1'b0),
+                .perf_rd_data(),
+                .perf_rd_valid()
+            );
+        end
+    endgenerate
+
+    assign ready = sel_valid && (rob_count != ROB_DEPTH);
+    assign nonce_ready = all_nonce_ready;
+    assign key_swap_pending = |core_swap_pending;
+    assign prf_out = out_reg;
+    assign prf_index = out_index;
+    assign done = out_done;
+
+    perf_counter_bank #(
+        .NUM_EVENTS(10),
+        .ADDR_WIDTH(5),
+        .INSTANCES(CORES)
+    ) perf (
+        .clk(clk),
+        .rst_n(rst_n),
+        .events(core_perf),
+        .csr_sel(perf_core),
+        .csr_addr(perf_addr),
+        .csr_wr_en(perf_wr_en),
+        .csr_wr_data(perf_wr_data),
+        .csr_rd_en(perf_rd_en),
+        .csr_rd_data(perf_rd_data),
+        .csr_rd_valid(perf_rd_valid)
+    );
+
+endmodule
@@ -0,0 +1,196 @@
+// Counter-mode keystream engine: one command (first_index, count) yields
+// the PRF outputs of indices first_index .. first_index + count - 1 in
+// order on an AXI4-Stream master, TLAST on the command's last output.
+//
+// The nonce is streamed in beforehand (nonce_* as in prf_evaluate) and
+// applies to every command after it; nonce_ready is low while a command
+// still has indices to issue. Indices are issued to the prf_farm back to
+// back while the output FIFO has room for their results, so m_axis_tready
+// backpressure stalls issue instead of dropping outputs. A new command is
+// accepted as soon as the previous one has issued its last index.
+//
+// cmd_ready is low until the farm has a whole nonce (see hash_to_vector),
+// and nonce_ready is low in the cycle a command is taken. A command with
+// cmd_count 0 is accepted and produces no transfers (and no TLAST).
+//
+// The slots are evaluated by a prf_farm of CORES cores; FIFO_DEPTH bounds
+// the slots in flight, so keep it at 2 * CORES or more.
+module prf_keystream #(
+    parameter N_LWR = 445,
+    parameter N = 2048,
+    parameter P = 32,
+    parameter ROUNDS_PER_CYCLE = 1, // keccak_f1600 rounds per clock
+    parameter ELEMS_PER_CYCLE = 1,  // hash elements per dot product beat
+    parameter KEY_FILE = "secret_key.mem",
+    parameter CORES = 1,            // prf_evaluate instances in the farm
+    parameter FIFO_DEPTH = 8        // output FIFO entries, power of 2 (>= 2)
+) (
+    input wire clk,
+    input wire rst_n,
+
+    input wire [63:0] nonce_data,
+    input wire [7:0] nonce_keep,
+    input wire nonce_valid,
+    input wire nonce_last,
+    output wire nonce_ready,
+
+    // Command
+    input wire [63:0] cmd_first_index,
+    input wire [31:0] cmd_count,
+    input wire cmd_valid,
+    output wire cmd_ready,
+
+    // Key store (see prf_evaluate)
+    input wire key_wr_en,
+    input wire [$clog2(N_LWR)-1:0] key_wr_addr,
+    input wire [31:0] key_wr_data,
+    input wire key_swap,
+    output wire key_swap_pending,
+
+    // AXI4-Stream keystream, one PRF output per transfer in the low bits
+    output wire [((($clog2(P) + 7) / 8) * 8)-1:0] m_axis_tdata,
+    output wire m_axis_tvalid,
+    input wire m_axis_tready,
+    output wire m_axis_tlast,
+
+    // Performance counters of farm core perf_core (see prf_farm)
+    input wire [((CORES > 1) ? $clog2(CORES) : 1)-1:0] perf_core,
+    input wire [4:0] perf_addr,
+    input wire perf_wr_en,
+    input wire [31:0] perf_wr_data,
+    input wire perf_rd_en,
+    output wire [31:0] perf_rd_data,
+    output wire perf_rd_valid
+);
+
+    localparam OUT_WIDTH = $clog2(P);
+    localparam TDATA_WIDTH = ((OUT_WIDTH + 7) / 8) * 8;
+    localparam FPTR_WIDTH = (FIFO_DEPTH > 1) ? $clog2(FIFO_DEPTH) : 1;
+
+    // Command in progress: next index to issue and indices left
+    reg [63:0] next_index;
+    reg [31:0] issue_left;
+    reg nonce_loaded; // tracks the farm's nonce from the beats passed on
+
+    // Slots issued and not yet done; their TLAST flags in issue order
+    reg [FPTR_WIDTH:0] in_flight;
+    reg tag_last [0:FIFO_DEPTH-1];
+    reg [FPTR_WIDTH-1:0] tag_wr;
+    reg [FPTR_WIDTH-1:0] tag_rd;
+
+    // Output FIFO
+    reg [OUT_WIDTH-1:0] fifo_data [0:FIFO_DEPTH-1];
+    reg fifo_last [0:FIFO_DEPTH-1];
+    reg [FPTR_WIDTH-1:0] fifo_wr;
+    reg [FPTR_WIDTH-1:0] fifo_rd;
+    reg [FPTR_WIDTH:0] fifo_count;
+
+    wire prf_ready;
+    wire prf_nonce_ready;
+    wire [OUT_WIDTH-1:0] prf_out;
+    wire prf_done;
+
+    // Every issued slot has a FIFO entry reserved for its result
+    wire issue = (issue_left != 0) && prf_ready && (in_flight + fifo_count < FIFO_DEPTH);
+    wire pop = m_axis_tvalid && m_axis_tready;
+    wire cmd_take = cmd_valid && cmd_ready;
+
+    assign cmd_ready = (issue_left == 0) && nonce_loaded;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            next_index <= 64'd0;
+            issue_left <= 32'd0;
+            nonce_loaded <= 1'b0;
+            in_flight <= 0;
+            tag_wr <= 0;
+            tag_rd <= 0;
+            fifo_wr <= 0;
+            fifo_rd <= 0;
+            fifo_count <= 0;
+        end
+        else begin
+            if (nonce_valid && nonce_ready)
+                nonce_loaded <= nonce_last;
+
+            if (cmd_take) begin
+                next_index <= cmd_first_index;
+                issue_left <= cmd_count;
+            end
+            else if (issue) begin
+                next_index <= next_index + 1'd1;
+                issue_left <= issue_left - 1'd1;
+            end
+
+            if (issue) begin
+                tag_last[tag_wr] <= (issue_left == 1);
+                tag_wr <= tag_wr + 1'd1;
+            end
+
+            if (issue && !prf_done)
+                in_flight <= in_flight + 1'd1;
+            else if (prf_done && !issue)
+                in_flight <= in_flight - 1'd1;
+
+            // Results arrive in issue order
+            if (prf_done) begin
+                fifo_data[fifo_wr] <= prf_out;
+                fifo_last[fifo_wr] <= tag_last[tag_rd];
+                fifo_wr <= fifo_wr + 1'd1;
+                tag_rd <= tag_rd + 1'd1;
+            end
+
+            if (pop)
+                fifo_rd <= fifo_rd + 1'd1;
+
+            if (prf_done && !pop)
+                fifo_count <= fifo_count + 1'd1;
+            else if (pop && !prf_done)
+                fifo_count <= fifo_count - 1'd1;
+        end
+    end
+
+    prf_farm #(
+        .N_LWR(N_LWR),
+        .N(N),
+        .P(P),
+        .ROUNDS_PER_CYCLE(ROUNDS_PER_CYCLE),
+        .ELEMS_PER_CYCLE(ELEMS_PER_CYCLE),
+        .KEY_FILE(KEY_FILE),
+        .CORES(CORES)
+    ) prf (
+        .clk(clk),
+        .rst_n(rst_n),
+        .start(issue),
+        .ready(prf_ready),
+        .nonce_data(nonce_data),
+        .nonce_keep(nonce_keep),
+        .nonce_valid(nonce_valid && nonce_ready),
+        .nonce_last(nonce_last),
+        .nonce_ready(prf_nonce_ready),
+        .index(next_index),
+        .key_wr_en(key_wr_en),
+        .key_wr_key(1'b0),
+        .key_wr_addr(key_wr_addr),
+        .key_wr_data(key_wr_data),
+        .key_swap(key_swap),
+        .key_swap_pending(key_swap_pending),
+        .prf_out(prf_out),
+        .prf_index(),
+        .done(prf_done),
+        .perf_core(perf_core),
+        .perf_addr(perf_addr),
+        .perf_wr_en(perf_wr_en),
+        .perf_wr_data(perf_wr_data),
+        .perf_rd_en(perf_rd_en),
+        .perf_rd_data(perf_rd_data),
+        .perf_rd_valid(perf_rd_valid)
+    );
+
+    assign nonce_ready = prf_nonce_ready && (issue_left == 0) && !cmd_take;
+
+    assign m_axis_tvalid = (fifo_count != 0);
+    assign m_axis_tdata = fifo_data[fifo_rd]; // zero-extended to TDATA_WIDTH
+    assign m_axis_tlast = fifo_last[fifo_rd];
+
+endmodule
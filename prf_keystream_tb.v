@@ -0,0 +1,243 @@
+`timescale 1ns / 1ps
+
+module prf_keystream_tb;
+    // Parameters
+    localparam N_LWR = 445;
+    localparam N = 2048;
+    localparam P = 32;
+    localparam CLK_PERIOD = 10; // 10ns = 100MHz
+    localparam [63:0] TEST_NONCE = 64'h646565735f72776c; // "lwr_seed", first byte in [7:0]
+    localparam NUM_OUTPUTS = 6;
+
+    // Signals
+    reg clk;
+    reg rst_n;
+    reg [63:0] nonce_data;
+    reg [7:0] nonce_keep;
+    reg nonce_valid;
+    reg nonce_last;
+    wire nonce_ready;
+    reg [63:0] cmd_first_index;
+    reg [31:0] cmd_count;
+    reg cmd_valid;
+    wire cmd_ready;
+    wire [7:0] tdata;
+    wire tvalid;
+    reg tready;
+    wire tlast;
+    reg perf_core;
+    reg [4:0] perf_addr;
+    reg perf_rd_en;
+    wire [31:0] perf_rd_data;
+    wire perf_rd_valid;
+
+    // Instantiate DUT (Device Under Test)
+    prf_keystream #(
+        .N_LWR(N_LWR),
+        .N(N),
+        .P(P),
+        .CORES(2) // slots alternate between two cores
+    ) dut (
+        .clk(clk),
+        .rst_n(rst_n),
+        .nonce_data(nonce_data),
+        .nonce_keep(nonce_keep),
+        .nonce_valid(nonce_valid),
+        .nonce_last(nonce_last),
+        .nonce_ready(nonce_ready),
+        .cmd_first_index(cmd_first_index),
+        .cmd_count(cmd_count),
+        .cmd_valid(cmd_valid),
+        .cmd_ready(cmd_ready),
+        .key_wr_en(1'b0),
+        .key_wr_addr(9'd0),
+        .key_wr_data(32'd0),
+        .key_swap(1'b0),
+        .key_swap_pending(),
+        .m_axis_tdata(tdata),
+        .m_axis_tvalid(tvalid),
+        .m_axis_tready(tready),
+        .m_axis_tlast(tlast),
+        .perf_core(perf_core),
+        .perf_addr(perf_addr),
+        .perf_wr_en(1'b0),
+        .perf_wr_data(32'd0),
+        .perf_rd_en(perf_rd_en),
+        .perf_rd_data(perf_rd_data),
+        .perf_rd_valid(perf_rd_valid)
+    );
+
+    // Clock generation
+    initial begin
+        clk = 0;
+        forever #(CLK_PERIOD/2) clk = ~clk;
+    end
+
+    // Expected stream (generate_test_vectors.py nonce): command 1 is
+    // indices 0..3, command 2 is indices 4..5
+    reg [4:0] expected [0:NUM_OUTPUTS-1];
+    reg expected_last [0:NUM_OUTPUTS-1];
+    integer received;
+    integer errors;
+    reg [31:0] perf_value [0:1];
+    integer c;
+
+    // Register read from the perf_counters of one farm core
+    task csr_read;
+        input core;
+        input [4:0] addr;
+        output [31:0] data;
+        begin
+            perf_core = core;
+            perf_addr = addr;
+            perf_rd_en = 1;
+            #CLK_PERIOD;
+            perf_rd_en = 0;
+            if (!perf_rd_valid) begin
+                $display("    ✗ FAIL: no read data from core %0d", core);
+                errors = errors + 1;
+            end
+            data = perf_rd_data;
+        end
+    endtask
+
+    // Check every AXI4-Stream transfer
+    always @(posedge clk) begin
+        if (rst_n && tvalid && tready) begin
+            if (received >= NUM_OUTPUTS) begin
+                $display("    ✗ FAIL: unexpected transfer %0d (0x%02h)", received, tdata);
+                errors = errors + 1;
+            end
+            else if (tdata == expected[received] && tlast == expected_last[received]) begin
+                $display("    ✓ PASS: output %0d -> %0d%s", received, tdata, tlast ? " (TLAST)" : "");
+            end
+            else begin
+                $display("    ✗ FAIL: output %0d expected %0d/last=%0d, got %0d/last=%0d",
+                         received, expected[received], expected_last[received], tdata, tlast);
+                errors = errors + 1;
+            end
+            received = received + 1;
+        end
+    end
+
+    // Backpressure: tready low every third cycle
+    integer cycle;
+    always @(posedge clk) begin
+        if (!rst_n)
+            cycle <= 0;
+        else
+            cycle <= cycle + 1;
+    end
+    always @(negedge clk)
+        tready <= (cycle % 3) != 2;
+
+    initial begin
+        expected[0] = 8;  expected_last[0] = 0;
+        expected[1] = 29; expected_last[1] = 0;
+        expected[2] = 5;  expected_last[2] = 0;
+        expected[3] = 12; expected_last[3] = 1;
+        expected[4] = 10; expected_last[4] = 0;
+        expected[5] = 3;  expected_last[5] = 1;
+        received = 0;
+        errors = 0;
+
+        // Initialize signals
+        rst_n = 0;
+        nonce_data = 64'h0;
+        nonce_keep = 8'h0;
+        nonce_valid = 0;
+        nonce_last = 0;
+        cmd_first_index = 64'd0;
+        cmd_count = 32'd0;
+        cmd_valid = 0;
+        perf_core = 0;
+        perf_addr = 5'd0;
+        perf_rd_en = 0;
+
+        $display("================================================================================");
+        $display("PRF Keystream Testbench");
+        $display("================================================================================");
+        $display("Parameters: N_LWR=%0d, N=%0d, P=%0d", N_LWR, N, P);
+        $display("");
+
+        // Release reset
+        #(CLK_PERIOD * 2);
+        rst_n = 1;
+        #(CLK_PERIOD);
+
+        // No command is taken before the nonce
+        cmd_valid = 1;
+        #(CLK_PERIOD * 3);
+        if (cmd_ready) begin
+            $display("    ✗ FAIL: cmd_ready high before the nonce");
+            errors = errors + 1;
+        end
+        else
+            $display("    ✓ PASS: cmd_ready low until the nonce is loaded");
+        cmd_valid = 0;
+
+        // Nonce: one full last beat
+        nonce_data = TEST_NONCE;
+        nonce_keep = 8'hFF;
+        nonce_last = 1;
+        nonce_valid = 1;
+        while (!nonce_ready)
+            #CLK_PERIOD;
+        #CLK_PERIOD;
+        nonce_valid = 0;
+
+        // Two back-to-back commands
+        $display("Test Case 1: Commands (0, 4) and (4, 2) with backpressure");
+        cmd_first_index = 64'd0;
+        cmd_count = 32'd4;
+        cmd_valid = 1;
+        while (!cmd_ready)
+            #CLK_PERIOD;
+        #CLK_PERIOD;
+        cmd_first_index = 64'd4;
+        cmd_count = 32'd2;
+        while (!cmd_ready)
+            #CLK_PERIOD;
+        #CLK_PERIOD;
+        cmd_valid = 0;
+
+        wait(received == NUM_OUTPUTS);
+        #(CLK_PERIOD * 20);
+        $display("");
+
+        // Each slot runs (N_LWR + 16) / 17 permutations on whichever core
+        // took it (register 2: keccak_f1600 permutations)
+        $display("Test Case 2: Per-core performance counters");
+        @(negedge clk); // CSR accesses between clock edges
+        for (c = 0; c < 2; c = c + 1) begin
+            csr_read(c, 5'd2, perf_value[c]);
+            $display("    core %0d: %0d permutations", c, perf_value[c]);
+        end
+        if (perf_value[0] + perf_value[1] == NUM_OUTPUTS * ((N_LWR + 16) / 17))
+            $display("    ✓ PASS: %0d permutations over both cores", perf_value[0] + perf_value[1]);
+        else begin
+            $display("    ✗ FAIL: expected %0d permutations over both cores, got %0d",
+                     NUM_OUTPUTS * ((N_LWR + 16) / 17), perf_value[0] + perf_value[1]);
+            errors = errors + 1;
+        end
+        $display("");
+
+        if (errors == 0 && received == NUM_OUTPUTS)
+            $display("✓ All %0d keystream outputs match", NUM_OUTPUTS);
+        else
+            $display("✗ %0d error(s), %0d of %0d outputs received", errors, received, NUM_OUTPUTS);
+
+        $display("================================================================================");
+        $display("Simulation Complete");
+        $display("================================================================================");
+        $finish;
+    end
+
+    // Timeout watchdog
+    initial begin
+        #(CLK_PERIOD * 20000); // 20000 cycles timeout
+        $display("ERROR: Simulation timeout!");
+        $finish;
+    end
+
+endmodule
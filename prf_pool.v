@@ -0,0 +1,220 @@
+// CONSUMERS independent PRF evaluators sharing a hash_pool of ENGINES
+// hash_to_vector engines. Each consumer has its own key store, dot product
+// and rounding, and the prf_evaluate request/result handshake in its bit
+// (or 64-bit lane) of start/ready/index and prf_out/prf_index/done; one
+// request is held while the previous slot is hashing, so a consumer asks
+// for an engine again as soon as its last element has left the pool.
+//
+// The nonce is shared by all engines. A consumer's ready waits for a whole
+// nonce to be in the engines (see hash_to_vector), and nonce_ready is low
+// while any consumer has a request waiting for an engine or being taken.
+// key_wr_* writes consumer key_wr_consumer's shadow bank and key_swap[c]
+// rotates consumer c's key between its slots (see secret_key).
+// perf_* reads and writes the performance counters of hash engine
+// perf_engine (see hash_pool).
+module prf_pool #(
+    parameter N_LWR = 445,
+    parameter N = 2048,
+    parameter P = 32,
+    parameter ROUNDS_PER_CYCLE = 1, // keccak_f1600 rounds per clock
+    parameter ELEMS_PER_CYCLE = 1,  // hash elements squeezed and summed per beat (1-17)
+    parameter KEY_FILE = "secret_key.mem", // initial key of every consumer, "" for none
+    parameter KEY_WORD_WIDTH = 32,  // key store word, power of 2 (>= ELEMS_PER_CYCLE)
+    parameter ENGINES = 2,          // hash_to_vector engines
+    parameter CONSUMERS = 4         // key store / dot product back-ends
+) (
+    input wire clk,
+    input wire rst_n,
+
+    input wire [CONSUMERS-1:0] start,
+    output wire [CONSUMERS-1:0] ready,
+
+    input wire [63:0] nonce_data,
+    input wire [7:0] nonce_keep,
+    input wire nonce_valid,
+    input wire nonce_last,
+    output wire nonce_ready,
+
+    input wire [CONSUMERS*64-1:0] index,
+
+    input wire key_wr_en,
+    input wire [((CONSUMERS > 1) ? $clog2(CONSUMERS) : 1)-1:0] key_wr_consumer,
+    input wire [$clog2(N_LWR)-1:0] key_wr_addr,
+    input wire [KEY_WORD_WIDTH-1:0] key_wr_data,
+    input wire [CONSUMERS-1:0] key_swap,
+    output wire [CONSUMERS-1:0] key_swap_pending,
+
+    output wire [CONSUMERS*$clog2(P)-1:0] prf_out,
+    output wire [CONSUMERS*64-1:0] prf_index,
+    output wire [CONSUMERS-1:0] done,
+
+    input wire [((ENGINES > 1) ? $clog2(ENGINES) : 1)-1:0] perf_engine,
+    input wire [4:0] perf_addr,
+    input wire perf_wr_en,
+    input wire [31:0] perf_wr_data,
+    input wire perf_rd_en,
+    output wire [31:0] perf_rd_data,
+    output wire perf_rd_valid
+);
+
+    localparam ELEM_WIDTH = $clog2(N) + 1;
+    localparam ACC_WIDTH = ELEM_WIDTH; // prf_rounding reads <a, s> mod 2N only
+    localparam ADDR_WIDTH = $clog2(N_LWR);
+    localparam OUT_WIDTH = $clog2(P);
+    localparam BEAT_WIDTH = ELEMS_PER_CYCLE * ELEM_WIDTH;
+
+    wire [CONSUMERS-1:0] req_valid;
+    wire [CONSUMERS*64-1:0] req_index;
+    wire [CONSUMERS-1:0] req_ready;
+
+    wire [CONSUMERS*BEAT_WIDTH-1:0] a_in;
+    wire [CONSUMERS*ADDR_WIDTH-1:0] idx;
+    wire [CONSUMERS*ELEMS_PER_CYCLE-1:0] mask;
+    wire [CONSUMERS-1:0] valid;
+    wire [CONSUMERS-1:0] last;
+
+    wire pool_nonce_ready;
+
+    hash_pool #(
+        .N_LWR(N_LWR),
+        .N(N),
+        .ELEM_WIDTH(ELEM_WIDTH),
+        .ROUNDS_PER_CYCLE(ROUNDS_PER_CYCLE),
+        .ELEMS_PER_CYCLE(ELEMS_PER_CYCLE),
+        .ENGINES(ENGINES),
+        .CONSUMERS(CONSUMERS)
+    ) pool (
+        .clk(clk),
+        .rst_n(rst_n),
+        .nonce_data(nonce_data),
+        .nonce_keep(nonce_keep),
+        .nonce_valid(nonce_valid && nonce_ready),
+        .nonce_last(nonce_last),
+        .nonce_ready(pool_nonce_ready),
+        .req_valid(req_valid),
+        .req_index(req_index),
+        .req_ready(req_ready),
+        .hash_out(a_in),
+        .hash_idx(idx),
+        .hash_mask(mask),
+        .hash_valid(valid),
+        .hash_last(last),
+        .perf_engine(perf_engine),
+        .perf_addr(perf_addr),
+        .perf_wr_en(perf_wr_en),
+        .perf_wr_data(perf_wr_data),
+        .perf_rd_en(perf_rd_en),
+        .perf_rd_data(perf_rd_data),
+        .perf_rd_valid(perf_rd_valid)
+    );
+
+    // Engines hold a whole nonce (nonce_loaded of each hash_to_vector)
+    reg nonce_loaded;
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n)
+            nonce_loaded <= 1'b0;
+        else if (nonce_valid && nonce_ready)
+            nonce_loaded <= nonce_last;
+    end
+
+    assign nonce_ready = pool_nonce_ready && (req_valid == 0) && ((start & ready) == 0);
+
+    genvar c;
+    generate
+        for (c = 0; c < CONSUMERS; c = c + 1) begin : consumer
+            // Request held until the pool takes it; slot in the pool and
+            // slot in the dot product tail
+            reg pending;
+            reg [63:0] pending_index;
+            reg [63:0] hash_index;
+            reg [63:0] dot_index;
+            reg slot_active;
+
+            always @(posedge clk or negedge rst_n) begin
+                if (!rst_n) begin
+                    pending <= 1'b0;
+                    pending_index <= 64'd0;
+                    hash_index <= 64'd0;
+                    dot_index <= 64'd0;
+                    slot_active <= 1'b0;
+                end
+                else begin
+                    if (start[c] && ready[c]) begin
+                        pending <= 1'b1;
+                        pending_index <= index[c*64 +: 64];
+                    end
+                    else if (req_ready[c]) begin
+                        pending <= 1'b0;
+                    end
+
+                    if (req_ready[c])
+                        hash_index <= pending_index;
+
+                    if (valid[c] && last[c])
+                        dot_index <= hash_index;
+
+                    if (req_ready[c])
+                        slot_active <= 1'b1;
+                    else if (valid[c] && last[c])
+                        slot_active <= 1'b0;
+                end
+            end
+
+            assign ready[c] = !pending && nonce_loaded;
+            assign req_valid[c] = pending;
+            assign req_index[c*64 +: 64] = pending_index;
+
+            wire [ELEMS_PER_CYCLE-1:0] key_bits;
+            wire [ACC_WIDTH-1:0] dot_prod;
+
+            secret_key #(
+                .N_LWR(N_LWR),
+                .KEY_FILE(KEY_FILE),
+                .LANES(ELEMS_PER_CYCLE),
+                .WORD_WIDTH(KEY_WORD_WIDTH)
+            ) sk (
+                .clk(clk),
+                .rst_n(rst_n),
+                .addr(idx[c*ADDR_WIDTH +: ADDR_WIDTH]),
+                .key_bits(key_bits),
+                .wr_en(key_wr_en && (CONSUMERS == 1 || key_wr_consumer == c)),
+                .wr_addr(key_wr_addr),
+                .wr_data(key_wr_data),
+                .swap(key_swap[c]),
+                .swap_ok(!slot_active || (valid[c] && last[c])), // last key read of a slot is this cycle
+                .swap_pending(key_swap_pending[c])
+            );
+
+            dot_product #(
+                .N_LWR(N_LWR),
+                .ELEM_WIDTH(ELEM_WIDTH),
+                .ACC_WIDTH(ACC_WIDTH),
+                .LANES(ELEMS_PER_CYCLE),
+                .NUM_KEYS(1)
+            ) dp (
+                .clk(clk),
+                .rst_n(rst_n),
+                .start(1'b0), // clears itself after a_last
+                .a_in(a_in[c*BEAT_WIDTH +: BEAT_WIDTH]),
+                .a_mask(mask[c*ELEMS_PER_CYCLE +: ELEMS_PER_CYCLE]),
+                .a_valid(valid[c]),
+                .a_last(last[c]),
+                .key_bits(key_bits),
+                .dot_product(dot_prod),
+                .done(done[c])
+            );
+
+            prf_rounding #(
+                .N(N),
+                .P(P),
+                .ACC_WIDTH(ACC_WIDTH)
+            ) round (
+                .inner_product(dot_prod),
+                .prf_out(prf_out[c*OUT_WIDTH +: OUT_WIDTH])
+            );
+
+            assign prf_index[c*64 +: 64] = dot_index;
+        end
+    endgenerate
+
+endmodule
@@ -1,21 +1,91 @@
+// Runtime-writable key store. The key is held as WORD_WIDTH-bit words
+// (key bit j in word j / WORD_WIDTH, bit j % WORD_WIDTH) in two banks:
+// reads come from the active bank, wr_* writes go to the shadow bank.
+// swap requests a bank switch, taken on the first cycle swap_ok is high
+// (the caller raises it between vectors) so a key rotation never changes
+// the key under an in-flight evaluation; swap_pending is high until then.
+//
+// key_bits[i] = s[addr + i]; the caller masks bits past N_LWR-1.
+// KEY_FILE (one bit per line, "" for none) initialises both banks.
 module secret_key #(
     parameter N_LWR = 445,
-    parameter KEY_FILE = "secret_key.mem"
+    parameter KEY_FILE = "secret_key.mem",
+    parameter LANES = 1,        // key bits per read
+    parameter WORD_WIDTH = 32   // power of 2, >= LANES
 ) (
+    input wire clk,
+    input wire rst_n,
+
     input wire [$clog2(N_LWR)-1:0] addr,
-    output wire key_bit
+    output wire [LANES-1:0] key_bits,
+
+    input wire wr_en,
+    input wire [$clog2(N_LWR)-1:0] wr_addr, // word index
+    input wire [WORD_WIDTH-1:0] wr_data,
+    input wire swap,
+    input wire swap_ok,
+    output reg swap_pending
 );
-    reg secret_key [0:N_LWR-1];
+    localparam WORDS = (N_LWR + WORD_WIDTH - 1) / WORD_WIDTH;
+    localparam OFFSET_WIDTH = (WORD_WIDTH > 1) ? $clog2(WORD_WIDTH) : 1;
+
+    reg [WORD_WIDTH-1:0] bank0 [0:WORDS-1];
+    reg [WORD_WIDTH-1:0] bank1 [0:WORDS-1];
+    reg active; // bank read by addr
+
+    reg key_init [0:N_LWR-1];
     integer i;
     initial begin
         // init
         for (i = 0; i < N_LWR; i = i + 1) begin
-            secret_key[i] = 1'b0;
+            key_init[i] = 1'b0;
         end
         // read from file
-        $readmemb(KEY_FILE, secret_key);
+        if (KEY_FILE != "")
+            $readmemb(KEY_FILE, key_init);
+        // pack into words
+        for (i = 0; i < WORDS; i = i + 1) begin
+            bank0[i] = {WORD_WIDTH{1'b0}};
+        end
+        for (i = 0; i < N_LWR; i = i + 1) begin
+            bank0[i / WORD_WIDTH][i % WORD_WIDTH] = key_init[i];
+        end
+        for (i = 0; i < WORDS; i = i + 1) begin
+            bank1[i] = bank0[i];
+        end
     end
 
-    assign key_bit = secret_key[addr];
+    // LANES <= WORD_WIDTH bits starting at addr span at most two words
+    wire [$clog2(N_LWR)-1:0] word = addr / WORD_WIDTH;
+    wire [OFFSET_WIDTH-1:0] offset = addr % WORD_WIDTH;
+    wire last_word = (word == WORDS - 1);
+    wire [WORD_WIDTH-1:0] lo = active ? bank1[word] : bank0[word];
+    wire [WORD_WIDTH-1:0] hi = last_word ? {WORD_WIDTH{1'b0}} :
+                               active ? bank1[word + 1'd1] : bank0[word + 1'd1];
+    wire [2*WORD_WIDTH-1:0] window = {hi, lo} >> offset;
+    assign key_bits = window[LANES-1:0];
+
+    always @(posedge clk) begin
+        if (wr_en) begin
+            if (active)
+                bank0[wr_addr] <= wr_data;
+            else
+                bank1[wr_addr] <= wr_data;
+        end
+    end
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            active <= 1'b0;
+            swap_pending <= 1'b0;
+        end
+        else if ((swap || swap_pending) && swap_ok) begin
+            active <= !active;
+            swap_pending <= 1'b0;
+        end
+        else if (swap) begin
+            swap_pending <= 1'b1;
+        end
+    end
 
-endmodule
\ No newline at end of file
+endmodule
@@ -1,24 +1,58 @@
-module shake256 (
+module shake256 #(
+    parameter ROUNDS_PER_CYCLE = 1, // keccak_f1600 rounds per clock
+    parameter ABSORB_LANES = 1,     // 64-bit lanes accepted per absorb beat (1-17)
+    parameter SQUEEZE_LANES = 1     // 64-bit lanes emitted per squeeze beat (1-17)
+) (
     input wire clk,
     input wire rst_n,
 
     input wire start,
 
     // Absorb
-    input wire [63:0] data_in,
-    input wire [7:0] data_in_keep,
+    // Lane i of a beat is data_in[64*i +: 64] with byte enables
+    // data_in_keep[8*i +: 8]. Every beat but the last advances ABSORB_LANES
+    // lanes; the last beat's keep must be a contiguous run from byte 0.
+    input wire [64*ABSORB_LANES-1:0] data_in,
+    input wire [8*ABSORB_LANES-1:0] data_in_keep,
     input wire data_in_valid,
     output wire data_in_ready,
     input wire data_in_last,
 
-    // Squeeze
+    // Load: taken instead of start (out_len/stream are sampled the same
+    // way) and replaces the absorb with a prepared state. With load_final
+    // the state is already padded and the squeeze follows its permutation;
+    // otherwise it is permuted and absorb continues at lane 0 (a midstate).
+    // A load is also taken while absorbing, abandoning the open message;
+    // state_out is the sponge state, valid as a midstate while
+    // data_in_ready is high at a block boundary.
+    input wire [1599:0] load_state,
+    input wire load_valid,
+    input wire load_final,
+    output wire [1599:0] state_out,
+
+    // Squeeze: lane i of a beat is data_out[64*i +: 64]. A beat never
+    // crosses the end of a rate block, so the beat that ends a block may
+    // carry fewer lanes; unused lanes read as zero with keep low.
+    // stream (sampled with start) selects an unbounded XOF squeeze: beats
+    // are produced while data_out_ready is high until stop. A beat accepted
+    // with stop high is the last one and its final lane keeps out_len[2:0]
+    // bytes (0 = all 8); stop with data_out_ready low ends the stream
+    // without another beat.
     input wire [12:0] out_len,
-    output wire [63:0] data_out,
-    output wire [7:0] data_out_keep,
+    input wire stream,
+    input wire stop,
+    output wire [64*SQUEEZE_LANES-1:0] data_out,
+    output wire [8*SQUEEZE_LANES-1:0] data_out_keep,
     output wire data_out_valid,
     input wire data_out_ready,
     output wire data_out_last,
-    output wire done
+    output wire done,
+
+    // Per-cycle events for perf_counters: [0] keccak_f1600 busy,
+    // [1] permutation done, [2] message in progress (absorb to squeeze,
+    // or a load's permutation), [3] absorb stall (data_in_valid low in an
+    // open message), [4] squeeze stall (data_out_ready low)
+    output wire [4:0] perf_events
 );
 
     // Parameters
@@ -31,6 +65,7 @@ module shake256 (
     localparam [2:0] S_SQUEEZE_PERM = 3'd6;
     localparam [2:0] S_DONE = 3'd7;
     localparam RATE_LANES = 5'd17;
+    localparam RATE_BYTES = 9'd136;
 
     // Signals
     reg [2:0] fsm_state;
@@ -38,19 +73,39 @@ module shake256 (
     reg [4:0] lane_counter;
     reg [12:0] output_len_reg;
     reg [12:0] output_count;
-    reg [3:0] pad_pos;
+    reg stream_reg;
+    reg msg_open; // absorbing or squeezing a message, not a parked midstate
+    reg [7:0] pad_pos; // byte offset of the 0x1F pad byte within the rate
     reg pad_after_perm;
 
+    // Lanes of a wide beat that run past the end of the rate block are held
+    // here and XORed into lanes 0.. of the next block after the permutation
+    reg [64*ABSORB_LANES-1:0] carry_lanes;
+    reg [4:0] carry_count;
+
+    // Double-buffered squeeze: each block's rate is copied into rate_buf and
+    // the core is restarted on the full state at once, so the next block is
+    // permuted while this one streams out. gen_bytes counts the bytes of the
+    // blocks copied so far; core_hold marks a finished block still waiting
+    // in the core for rate_buf to drain.
+    reg [64*RATE_LANES-1:0] rate_buf;
+    reg [13:0] gen_bytes;
+    reg core_hold;
+
     // Keccak
     reg perm_start;
+    wire perm_resume; // squeeze: permute the core's own output, no load cycle
     wire perm_ready;
     wire perm_done;
     wire [1599:0] perm_state_out;
 
-    keccak_f1600 keccak (
+    keccak_f1600 #(
+        .ROUNDS_PER_CYCLE(ROUNDS_PER_CYCLE)
+    ) keccak (
         .clk        (clk),
         .rst_n      (rst_n),
-        .start      (perm_start),
+        .start      (perm_start || perm_resume),
+        .chain      (perm_resume),
         .state_in   (keccak_state),
         .state_out  (perm_state_out),
         .ready      (perm_ready),
@@ -69,48 +124,87 @@ module shake256 (
         end
     endfunction
 
-    // Count valid bytes from keep signal
-    function [3:0] count_bytes;
-        input [7:0] keep;
+    // Count valid bytes from keep signal (leading run of ones from byte 0)
+    function [8:0] count_bytes;
+        input [8*ABSORB_LANES-1:0] keep;
+        integer i;
         begin
-            case (keep)
-                8'b00000000: count_bytes = 4'd0;
-                8'b00000001: count_bytes = 4'd1;
-                8'b00000011: count_bytes = 4'd2;
-                8'b00000111: count_bytes = 4'd3;
-                8'b00001111: count_bytes = 4'd4;
-                8'b00011111: count_bytes = 4'd5;
-                8'b00111111: count_bytes = 4'd6;
-                8'b01111111: count_bytes = 4'd7;
-                8'b11111111: count_bytes = 4'd8;
-                default:     count_bytes = 4'd0;
-            endcase
+            count_bytes = 9'd0;
+            for (i = 0; i < 8*ABSORB_LANES; i = i + 1) begin
+                if (keep[i] && count_bytes == i)
+                    count_bytes = count_bytes + 1'd1;
+            end
         end
     endfunction
 
-    // Current lane
-    wire [63:0] current_lane = keccak_state[lane_counter*64 +: 64];
+    // Absorb: XOR every lane of the beat into the rate, overflow into carry
+    reg [1599:0] absorb_state;
+    reg [64*ABSORB_LANES-1:0] absorb_carry;
+    integer al;
+    always @(*) begin
+        absorb_state = keccak_state;
+        absorb_carry = {64*ABSORB_LANES{1'b0}};
+        for (al = 0; al < ABSORB_LANES; al = al + 1) begin
+            if (lane_counter + al < RATE_LANES)
+                absorb_state[(lane_counter + al)*64 +: 64] = keccak_state[(lane_counter + al)*64 +: 64]
+                                                             ^ mask_data(data_in[al*64 +: 64], data_in_keep[al*8 +: 8]);
+            else
+                absorb_carry[(lane_counter + al - RATE_LANES)*64 +: 64] = mask_data(data_in[al*64 +: 64], data_in_keep[al*8 +: 8]);
+        end
+    end
+
+    wire [5:0] absorb_next = lane_counter + ABSORB_LANES;
+    wire block_full = (absorb_next >= RATE_LANES);
+
+    // Loads are taken when the core is idle: between messages or while
+    // the absorb waits for data
+    wire take_load = load_valid && (((fsm_state == S_IDLE || fsm_state == S_DONE) && perm_ready) ||
+                                    fsm_state == S_ABSORB);
+    wire [5:0] overflow_lanes = absorb_next - RATE_LANES;
+
+    // End of the message on the last beat, as a byte offset into the rate
+    wire [9:0] msg_end = lane_counter*8 + count_bytes(data_in_keep);
+
+    // Squeeze lanes are read from rate_buf; S_SQUEEZE_PERM means the buffer
+    // is empty and waiting on the core.
+    wire squeeze_valid = (fsm_state == S_SQUEEZE);
+    wire squeezing = (fsm_state == S_SQUEEZE) || (fsm_state == S_SQUEEZE_PERM);
+
+    // Lanes in this beat, clipped at the end of the rate block
+    wire [4:0] lanes_left = RATE_LANES - lane_counter;
+    wire [4:0] beat_lanes = (lanes_left < SQUEEZE_LANES) ? lanes_left : SQUEEZE_LANES;
+    wire block_end = (beat_lanes == lanes_left);
+    wire [64*RATE_LANES-1:0] squeeze_window = rate_buf >> (lane_counter*64);
 
     // Squeeze logic
     wire [12:0] bytes_remaining = output_len_reg - output_count;
-    wire is_last_squeeze = (bytes_remaining <= 13'd8);
-    
-    // Generate keep signal for output
-    reg [7:0] out_keep;
+    wire [12:0] beat_bytes = beat_lanes * 8;
+    wire is_last_squeeze = stream_reg ? stop : (bytes_remaining <= beat_bytes);
+    wire [12:0] stream_bytes = (output_len_reg[2:0] == 3'd0) ? beat_bytes
+                               : beat_bytes - 13'd8 + output_len_reg[2:0];
+    wire [12:0] out_bytes = !is_last_squeeze ? beat_bytes :
+                            stream_reg ? stream_bytes : bytes_remaining;
+    wire squeeze_empty = !stream_reg && (output_len_reg == 13'd0);
+
+    // Copy a finished block into rate_buf once the buffer is empty or its
+    // final beat leaves this cycle, and restart the core if more is needed
+    wire block_avail = perm_done || core_hold;
+    wire stream_end = stream_reg && stop && !data_out_ready;
+    wire buf_free = (fsm_state == S_SQUEEZE_PERM && !stream_end) ||
+                    (squeeze_valid && data_out_ready && block_end && !is_last_squeeze);
+    wire capture = (fsm_state == S_PAD_PERM && perm_done && !squeeze_empty) ||
+                   (squeezing && block_avail && buf_free);
+    wire [13:0] gen_next = (fsm_state == S_PAD_PERM) ? RATE_BYTES : gen_bytes + RATE_BYTES;
+    wire more_blocks = stream_reg || (gen_next < output_len_reg);
+
+    // Generate keep and data for output (capacity lanes never leave the core)
+    reg [8*SQUEEZE_LANES-1:0] out_keep;
+    reg [64*SQUEEZE_LANES-1:0] out_data;
+    integer ob;
     always @(*) begin
-        if (bytes_remaining >= 13'd8)
-            out_keep = 8'b11111111;
-        else begin
-            case (bytes_remaining[2:0])
-                3'd0: out_keep = 8'b00000000;
-                3'd1: out_keep = 8'b00000001;
-                3'd2: out_keep = 8'b00000011;
-                3'd3: out_keep = 8'b00000111;
-                3'd4: out_keep = 8'b00001111;
-                3'd5: out_keep = 8'b00011111;
-                3'd6: out_keep = 8'b00111111;
-                3'd7: out_keep = 8'b01111111;
-            endcase
+        for (ob = 0; ob < 8*SQUEEZE_LANES; ob = ob + 1) begin
+            out_keep[ob] = (ob < out_bytes);
+            out_data[ob*8 +: 8] = (ob < beat_bytes) ? squeeze_window[ob*8 +: 8] : 8'h00;
         end
     end
 
@@ -122,67 +216,89 @@ module shake256 (
             lane_counter <= 5'd0;
             output_len_reg <= 13'd0;
             output_count <= 13'd0;
-            pad_pos <= 4'd0;
+            stream_reg <= 1'b0;
+            msg_open <= 1'b0;
+            pad_pos <= 8'd0;
             perm_start <= 1'b0;
             pad_after_perm <= 1'b0;
+            carry_lanes <= {64*ABSORB_LANES{1'b0}};
+            carry_count <= 5'd0;
         end
         else begin
             perm_start <= 1'b0; // Default
 
-            case (fsm_state)
-                S_IDLE: begin
-                    if (start) begin
-                        fsm_state <= S_ABSORB;
-                        keccak_state <= 1600'd0;
+            if (take_load) begin
+                lane_counter <= 5'd0;
+                output_len_reg <= out_len;
+                output_count <= 13'd0;
+                stream_reg <= stream;
+                msg_open <= load_final;
+                pad_after_perm <= 1'b0;
+                carry_count <= 5'd0;
+                keccak_state <= load_state;
+                carry_lanes <= {64*ABSORB_LANES{1'b0}};
+                perm_start <= 1'b1;
+                fsm_state <= load_final ? S_PAD_PERM : S_ABSORB_PERM;
+            end
+            else case (fsm_state)
+                // Idle or done; a stopped stream may still have the core busy
+                S_IDLE, S_DONE: begin
+                    if (start && perm_ready) begin
                         lane_counter <= 5'd0;
                         output_len_reg <= out_len;
                         output_count <= 13'd0;
+                        stream_reg <= stream;
+                        msg_open <= 1'b1;
                         pad_after_perm <= 1'b0;
+                        carry_count <= 5'd0;
+                        keccak_state <= 1600'd0;
+                        fsm_state <= S_ABSORB;
                     end
                 end
 
                 S_ABSORB: begin
                     if (data_in_valid) begin
-                        // XOR masked input into current state lane
-                        keccak_state[lane_counter*64 +: 64] <= current_lane ^ mask_data(data_in, data_in_keep);
-                        
-                        if (data_in_last) begin
-                            // Save padding position and go to PAD state
-                            pad_pos <= count_bytes(data_in_keep);
+                        msg_open <= 1'b1; // data continues a loaded midstate
+                        // XOR masked input into the state lanes of this beat
+                        keccak_state <= absorb_state;
+                        carry_lanes <= absorb_carry;
 
-                            if (data_in_keep == 8'hFF && lane_counter == RATE_LANES - 1) begin
-                                // Need to permute then pad next block
-                                lane_counter <= 5'd0;
+                        if (data_in_last) begin
+                            if (msg_end >= RATE_BYTES) begin
+                                // Message fills the rate: permute then pad next block
+                                pad_pos <= msg_end - RATE_BYTES;
+                                carry_count <= overflow_lanes[4:0];
                                 perm_start <= 1'b1;
                                 pad_after_perm <= 1'b1;
                                 fsm_state <= S_ABSORB_PERM;
                             end
                             else begin
-                            fsm_state <= S_PAD;
+                                // Save padding position and go to PAD state
+                                pad_pos <= msg_end[7:0];
+                                fsm_state <= S_PAD;
                             end
                         end
 
-                        else if (lane_counter == RATE_LANES - 1) begin
+                        else if (block_full) begin
                             // Rate block full, trigger permutation
-                            lane_counter <= 5'd0;
+                            carry_count <= overflow_lanes[4:0];
                             perm_start <= 1'b1;
                             fsm_state <= S_ABSORB_PERM;
                         end
                         else begin
-                            lane_counter <= lane_counter + 1'd1;
+                            lane_counter <= absorb_next[4:0];
                         end
                     end
                 end
 
                 S_ABSORB_PERM: begin
                     if (perm_done) begin
-                        keccak_state <= perm_state_out;
-                        lane_counter <= 5'd0;
+                        keccak_state <= perm_state_out ^ {{(1600-64*ABSORB_LANES){1'b0}}, carry_lanes};
+                        lane_counter <= carry_count;
 
                         if (pad_after_perm) begin
-                            // Go to PAD state
+                            // Go to PAD state (pad_pos already set for the new block)
                             pad_after_perm <= 1'b0;
-                            pad_pos <= 4'd0; // Padd at start of new block
                             fsm_state <= S_PAD;
                         end
                         else begin
@@ -194,31 +310,32 @@ module shake256 (
                 S_SQUEEZE: begin
                     if (data_out_ready) begin
                         // Update byte count
-                        if (bytes_remaining >= 13'd8)
-                            output_count <= output_count + 13'd8;
-                        else
-                            output_count <= output_len_reg;
-                        
+                        output_count <= output_count + out_bytes;
+
                         if (is_last_squeeze) begin
                             // All output complete
                             fsm_state <= S_DONE;
                         end
-                        else if (lane_counter == RATE_LANES - 1) begin
-                            // Need more output, permute again
+                        else if (block_end) begin
+                            // Buffer drained: next block if ready, else wait
                             lane_counter <= 5'd0;
-                            perm_start <= 1'b1;
-                            fsm_state <= S_SQUEEZE_PERM;
+                            fsm_state <= capture ? S_SQUEEZE : S_SQUEEZE_PERM;
                         end
                         else begin
-                            lane_counter <= lane_counter + 1'd1;
+                            lane_counter <= lane_counter + beat_lanes;
                         end
                     end
+                    else if (stream_end) begin
+                        fsm_state <= S_DONE;
+                    end
                 end
 
-                // Squeeze perm done
+                // Squeeze buffer empty, waiting on the core
                 S_SQUEEZE_PERM: begin
-                    if (perm_done) begin
-                        keccak_state <= perm_state_out;
+                    if (stream_end) begin
+                        fsm_state <= S_DONE;
+                    end
+                    else if (capture) begin
                         lane_counter <= 5'd0;
                         fsm_state <= S_SQUEEZE;
                     end
@@ -226,12 +343,12 @@ module shake256 (
 
                 S_PAD: begin
                     // Same byte padding: 0x1F followed by 0x80 -> do combined XOR
-                    if (lane_counter == RATE_LANES - 1 && pad_pos == 4'd7) begin
-                        keccak_state[lane_counter*64 + pad_pos*8 +: 8] <= keccak_state[lane_counter*64 + pad_pos*8 +: 8] ^ 8'h9F;
+                    if (pad_pos == RATE_BYTES - 1) begin
+                        keccak_state[pad_pos*8 +: 8] <= keccak_state[pad_pos*8 +: 8] ^ 8'h9F;
                     end
                     else begin
-                    // XOR 0x1F at padding position in current lane
-                    keccak_state[lane_counter*64 + pad_pos*8 +: 8] <= keccak_state[lane_counter*64 + pad_pos*8 +: 8] ^ 8'h1F;
+                    // XOR 0x1F at padding position
+                    keccak_state[pad_pos*8 +: 8] <= keccak_state[pad_pos*8 +: 8] ^ 8'h1F;
     
                     // XOR 0x80 at byte 7 of lane 16 (last byte of rate)
                     keccak_state[(RATE_LANES-1)*64 + 56 +: 8] <= keccak_state[(RATE_LANES-1)*64 + 56 +: 8] ^ 8'h80;
@@ -243,39 +360,66 @@ module shake256 (
 
                 S_PAD_PERM: begin
                     if (perm_done) begin
-                        keccak_state <= perm_state_out;
+                        // First block goes to rate_buf (capture)
                         lane_counter <= 5'd0;
                         output_count <= 13'd0;
-                        
-                        if (output_len_reg == 13'd0)
+
+                        if (squeeze_empty)
                             fsm_state <= S_DONE;
                         else
                             fsm_state <= S_SQUEEZE;
                     end
                 end
 
-                // Done
-                S_DONE: begin
-                    if (start) begin
-                        keccak_state <= 1600'b0;
-                        lane_counter <= 5'd0;
-                        output_len_reg <= out_len;
-                        output_count <= 13'd0;
-                        fsm_state <= S_ABSORB;
-                    end
-                end
-
                 default: fsm_state <= S_IDLE;
             endcase
         end
     end
 
+    // Squeeze buffer
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            rate_buf <= {64*RATE_LANES{1'b0}};
+            gen_bytes <= 14'd0;
+            core_hold <= 1'b0;
+        end
+        else begin
+            if (capture) begin
+                rate_buf <= perm_state_out[64*RATE_LANES-1:0];
+                gen_bytes <= gen_next;
+                core_hold <= 1'b0;
+            end
+            else if (squeezing && perm_done) begin
+                core_hold <= 1'b1;
+            end
+            else if (!squeezing) begin
+                core_hold <= 1'b0;
+            end
+        end
+    end
+
+    // Restart the core on its own output as soon as its block is copied
+    assign perm_resume = capture && more_blocks;
+
     // Assign outputs
     assign data_in_ready = (fsm_state == S_ABSORB);
-    assign data_out = current_lane;
+    assign state_out = keccak_state;
+    assign data_out = out_data;
     assign data_out_keep = out_keep;
-    assign data_out_valid = (fsm_state == S_SQUEEZE);
-    assign done = (fsm_state == S_DONE);
-    assign data_out_last = (fsm_state == S_SQUEEZE) && is_last_squeeze;
+    assign data_out_valid = squeeze_valid;
+    // A stopped stream may leave a permutation in flight; done (and the
+    // next start) waits for the core to go idle
+    assign done = (fsm_state == S_DONE) && perm_ready;
+    assign data_out_last = squeeze_valid && is_last_squeeze;
+    // After a midstate load the FSM waits in absorb with no message; that
+    // is idle time, not a busy or stalled absorb
+    wire parked = (fsm_state == S_ABSORB) && !msg_open;
+    assign perf_events = {
+        squeeze_valid && !data_out_ready,
+        (fsm_state == S_ABSORB) && msg_open && !data_in_valid,
+        (fsm_state != S_IDLE) && (fsm_state != S_DONE) && !parked,
+        perm_done,
+        !perm_ready
+    };
 
 endmodule
\ No newline at end of file
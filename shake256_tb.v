@@ -1,25 +1,38 @@
 `timescale 1ns / 1ps
 
-module shake256_tb;
+module shake256_tb #(
+    parameter ROUNDS_PER_CYCLE = 1,
+    parameter ABSORB_LANES = 1,
+    parameter SQUEEZE_LANES = 1
+);
 
     // DUT signals
     reg          clk;
     reg          rst_n;
     reg          start;
-    reg  [63:0]  data_in;
-    reg  [7:0]   data_in_keep;
+    reg  [64*ABSORB_LANES-1:0] data_in;
+    reg  [8*ABSORB_LANES-1:0]  data_in_keep;
     reg          data_in_valid;
     reg          data_in_last;
     wire         data_in_ready;
     reg  [12:0]  out_len;
-    wire [63:0]  data_out;
-    wire [7:0]   data_out_keep;
+    reg          stream;
+    reg          stop;
+    reg  [1599:0] load_state;
+    reg          load_valid;
+    reg          load_final;
+    wire [64*SQUEEZE_LANES-1:0] data_out;
+    wire [8*SQUEEZE_LANES-1:0]  data_out_keep;
     wire         data_out_valid;
     reg          data_out_ready;
     wire         data_out_last;
     wire         done_sig;
 
-    shake256 uut (
+    shake256 #(
+        .ROUNDS_PER_CYCLE(ROUNDS_PER_CYCLE),
+        .ABSORB_LANES(ABSORB_LANES),
+        .SQUEEZE_LANES(SQUEEZE_LANES)
+    ) uut (
         .clk            (clk),
         .rst_n          (rst_n),
         .start          (start),
@@ -28,7 +41,12 @@ module shake256_tb;
         .data_in_valid  (data_in_valid),
         .data_in_ready  (data_in_ready),
         .data_in_last   (data_in_last),
+        .load_state     (load_state),
+        .load_valid     (load_valid),
+        .load_final     (load_final),
         .out_len        (out_len),
+        .stream         (stream),
+        .stop           (stop),
         .data_out       (data_out),
         .data_out_keep  (data_out_keep),
         .data_out_valid (data_out_valid),
@@ -40,14 +58,16 @@ module shake256_tb;
     // 10 ns clock
     always #5 clk = ~clk;
 
-    // Expected output lanes (44 entries total)
+    // Expected output lanes (52 entries total)
     //   Test 1: indices  0- 3  (4 lanes,  32 bytes)
     //   Test 2: indices  4- 7  (4 lanes,  32 bytes)
     //   Test 3: indices  8-11  (4 lanes,  32 bytes)
     //   Test 4: indices 12-43  (32 lanes, 256 bytes)
-    reg [63:0] expected_lanes [0:43];
+    //   Test 5: indices 44-47  (4 lanes,  32 bytes)
+    //   Test 6: indices 48-51  (4 lanes,  32 bytes)
+    reg [63:0] expected_lanes [0:51];
 
-    integer errors, total_errors, tc, timeout_cnt;
+    integer errors, total_errors, timeout_cnt;
     localparam TIMEOUT = 20000;
 
     // -------------------------------------------------------
@@ -65,12 +85,12 @@ module shake256_tb;
     endtask
 
     // -------------------------------------------------------
-    // Task: feed one 64-bit word through the absorb interface
+    // Task: feed one beat through the absorb interface
     // -------------------------------------------------------
-    task absorb_word;
-        input [63:0] word_data;
-        input [7:0]  keep;
-        input        is_last;
+    task absorb_beat;
+        input [64*ABSORB_LANES-1:0] beat_data;
+        input [8*ABSORB_LANES-1:0]  keep;
+        input                       is_last;
         begin
             // Wait until module is ready
             timeout_cnt = 0;
@@ -83,7 +103,7 @@ module shake256_tb;
             end
             // Drive data between clock edges
             #1;
-            data_in       = word_data;
+            data_in       = beat_data;
             data_in_keep  = keep;
             data_in_last  = is_last;
             data_in_valid = 1;
@@ -95,6 +115,45 @@ module shake256_tb;
         end
     endtask
 
+    // -------------------------------------------------------
+    // Task: feed one 64-bit word in lane 0 of a beat
+    // -------------------------------------------------------
+    task absorb_word;
+        input [63:0] word_data;
+        input [7:0]  keep;
+        input        is_last;
+        begin
+            absorb_beat(word_data, keep, is_last);
+        end
+    endtask
+
+    // -------------------------------------------------------
+    // Task: absorb num_bytes copies of a byte, packed
+    // ABSORB_LANES words per beat
+    // -------------------------------------------------------
+    task absorb_repeat;
+        input [7:0]   byte_data;
+        input integer num_bytes;
+        reg [64*ABSORB_LANES-1:0] beat;
+        reg [8*ABSORB_LANES-1:0]  keep;
+        integer sent, bi;
+        begin
+            sent = 0;
+            while (sent < num_bytes) begin
+                beat = 0;
+                keep = 0;
+                for (bi = 0; bi < 8*ABSORB_LANES; bi = bi + 1) begin
+                    if (sent + bi < num_bytes) begin
+                        beat[bi*8 +: 8] = byte_data;
+                        keep[bi]        = 1'b1;
+                    end
+                end
+                sent = sent + 8*ABSORB_LANES;
+                absorb_beat(beat, keep, sent >= num_bytes);
+            end
+        end
+    endtask
+
     // -------------------------------------------------------
     // Task: read squeeze output and compare with expected
     // -------------------------------------------------------
@@ -102,11 +161,12 @@ module shake256_tb;
         input integer test_num;
         input integer num_lanes;
         input integer base_idx;
-        integer li;
+        integer li, bl;
         reg [63:0] exp;
         begin
             data_out_ready = 1;
-            for (li = 0; li < num_lanes; li = li + 1) begin
+            li = 0;
+            while (li < num_lanes) begin
                 // Wait for valid output
                 timeout_cnt = 0;
                 while (!data_out_valid) begin
@@ -117,27 +177,32 @@ module shake256_tb;
                     end
                 end
 
-                // Compare data
-                exp = expected_lanes[base_idx + li];
-                if (data_out !== exp) begin
-                    $display("  FAIL lane %0d: expected %h, got %h", li, exp, data_out);
-                    errors = errors + 1;
+                // Compare every lane of the beat that carries data
+                for (bl = 0; bl < SQUEEZE_LANES; bl = bl + 1) begin
+                    if (data_out_keep[bl*8]) begin
+                        exp = expected_lanes[base_idx + li];
+                        if (data_out[bl*64 +: 64] !== exp) begin
+                            $display("  FAIL lane %0d: expected %h, got %h", li, exp, data_out[bl*64 +: 64]);
+                            errors = errors + 1;
+                        end
+                        li = li + 1;
+                    end
                 end
 
-                // Check last flag on final lane
-                if (li == num_lanes - 1) begin
+                // Check last flag on the beat holding the final lane
+                if (li >= num_lanes) begin
                     if (!data_out_last) begin
-                        $display("  FAIL lane %0d: data_out_last should be 1", li);
+                        $display("  FAIL lane %0d: data_out_last should be 1", li - 1);
                         errors = errors + 1;
                     end
                 end else begin
                     if (data_out_last) begin
-                        $display("  FAIL lane %0d: unexpected data_out_last", li);
+                        $display("  FAIL lane %0d: unexpected data_out_last", li - 1);
                         errors = errors + 1;
                     end
                 end
 
-                @(posedge clk); // advance to next lane
+                @(posedge clk); // advance to next beat
             end
             #1;
             data_out_ready = 0;
@@ -154,6 +219,80 @@ module shake256_tb;
         end
     endtask
 
+    // -------------------------------------------------------
+    // Task: stream-mode squeeze, stop on the beat holding lane
+    // num_lanes-1 and check the lanes up to it
+    // -------------------------------------------------------
+    task stream_and_check;
+        input integer num_lanes;
+        input integer base_idx;
+        input [7:0]   last_keep;
+        integer li, bl, beat_start;
+        reg [63:0] exp;
+        begin
+            data_out_ready = 1;
+            li = 0;
+            #1;
+            while (li < num_lanes) begin
+                timeout_cnt = 0;
+                while (!data_out_valid) begin
+                    @(posedge clk); #1;
+                    timeout_cnt = timeout_cnt + 1;
+                    if (timeout_cnt > TIMEOUT) begin
+                        $display("TIMEOUT: data_out_valid (lane %0d)", li); $finish;
+                    end
+                end
+
+                // Stop on the beat that reaches the final lane
+                beat_start = li;
+                for (bl = 0; bl < SQUEEZE_LANES; bl = bl + 1)
+                    if (data_out_keep[bl*8]) li = li + 1;
+                stop = (li >= num_lanes);
+                #0;
+
+                for (bl = 0; bl < SQUEEZE_LANES; bl = bl + 1) begin
+                    if (data_out_keep[bl*8] && beat_start + bl < num_lanes) begin
+                        exp = expected_lanes[base_idx + beat_start + bl];
+                        if (data_out[bl*64 +: 64] !== exp) begin
+                            $display("  FAIL lane %0d: expected %h, got %h", beat_start + bl, exp, data_out[bl*64 +: 64]);
+                            errors = errors + 1;
+                        end
+                    end
+                end
+
+                if (stop) begin
+                    if (!data_out_last) begin
+                        $display("  FAIL: data_out_last should be 1 with stop");
+                        errors = errors + 1;
+                    end
+                    if (data_out_keep[(li - beat_start - 1)*8 +: 8] !== last_keep) begin
+                        $display("  FAIL: final lane keep %b, expected %b",
+                                 data_out_keep[(li - beat_start - 1)*8 +: 8], last_keep);
+                        errors = errors + 1;
+                    end
+                end
+                else if (data_out_last) begin
+                    $display("  FAIL lane %0d: unexpected data_out_last", li - 1);
+                    errors = errors + 1;
+                end
+
+                @(posedge clk); #1;
+            end
+            data_out_ready = 0;
+            stop = 0;
+
+            // Wait for done
+            timeout_cnt = 0;
+            while (!done_sig) begin
+                @(posedge clk);
+                timeout_cnt = timeout_cnt + 1;
+                if (timeout_cnt > TIMEOUT) begin
+                    $display("TIMEOUT: done"); $finish;
+                end
+            end
+        end
+    endtask
+
     // -------------------------------------------------------
     // Main test sequence
     // -------------------------------------------------------
@@ -170,6 +309,11 @@ module shake256_tb;
         data_in_valid  = 0;
         data_in_last   = 0;
         out_len        = 0;
+        stream         = 0;
+        stop           = 0;
+        load_state     = 0;
+        load_valid     = 0;
+        load_final     = 0;
         data_out_ready = 0;
         total_errors   = 0;
 
@@ -209,19 +353,14 @@ module shake256_tb;
         // Test 3: SHAKE256(200 * 0xa3, 32)
         //   200 bytes = 25 words of 0xa3a3a3a3a3a3a3a3
         //   First 17 words fill rate block → permute
+        //   (beats of ABSORB_LANES words; lanes past 16 carry over)
         //   Next 8 words: 7 normal + 1 last
         //   Output: 4 lanes (indices 8-11)
         // ==================================================
         $display("\n=== Test 3: SHAKE256(200 x 0xa3, 32) ===");
         errors = 0;
         start_hash(13'd32);
-        // First 17 words (fills rate: lanes 0-16, word 16 triggers permutation)
-        for (tc = 0; tc < 17; tc = tc + 1)
-            absorb_word(64'ha3a3a3a3a3a3a3a3, 8'hFF, 0);
-        // Remaining 8 words (7 not-last + 1 last)
-        for (tc = 0; tc < 7; tc = tc + 1)
-            absorb_word(64'ha3a3a3a3a3a3a3a3, 8'hFF, 0);
-        absorb_word(64'ha3a3a3a3a3a3a3a3, 8'hFF, 1);
+        absorb_repeat(8'ha3, 200);
         squeeze_and_check(3, 4, 8);
         total_errors = total_errors + errors;
         $display("Test 3: %s", (errors == 0) ? "PASS" : "FAIL");
@@ -240,6 +379,73 @@ module shake256_tb;
         total_errors = total_errors + errors;
         $display("Test 4: %s", (errors == 0) ? "PASS" : "FAIL");
 
+        // ==================================================
+        // Test 5: SHAKE256(136 x 0xa3, 32)
+        //   Message ends exactly at the end of the rate:
+        //   permute, then pad at byte 0 of the next block
+        //   Output: 4 lanes (indices 44-47)
+        // ==================================================
+        $display("\n=== Test 5: SHAKE256(136 x 0xa3, 32) ===");
+        errors = 0;
+        start_hash(13'd32);
+        absorb_repeat(8'ha3, 136);
+        squeeze_and_check(5, 4, 44);
+        total_errors = total_errors + errors;
+        $display("Test 5: %s", (errors == 0) ? "PASS" : "FAIL");
+
+        // ==================================================
+        // Test 6: SHAKE256(141 x 0xa3, 32)
+        //   5 bytes spill into the second block (a carried
+        //   lane when ABSORB_LANES > 1)
+        //   Output: 4 lanes (indices 48-51)
+        // ==================================================
+        $display("\n=== Test 6: SHAKE256(141 x 0xa3, 32) ===");
+        errors = 0;
+        start_hash(13'd32);
+        absorb_repeat(8'ha3, 141);
+        squeeze_and_check(6, 4, 48);
+        total_errors = total_errors + errors;
+        $display("Test 6: %s", (errors == 0) ? "PASS" : "FAIL");
+
+        // ==================================================
+        // Test 7: SHAKE256("") in stream mode
+        //   Same output as test 4, drawn without a length and
+        //   stopped after lane 31 (out_len=3: final lane keeps
+        //   3 bytes)
+        //   Output: 32 lanes (indices 12-43)
+        // ==================================================
+        $display("\n=== Test 7: SHAKE256(\"\") stream mode ===");
+        errors = 0;
+        stream = 1;
+        start_hash(13'd3);
+        stream = 0;
+        absorb_word(64'h0, 8'h00, 1);
+        stream_and_check(32, 12, 8'h07);
+        total_errors = total_errors + errors;
+        $display("Test 7: %s", (errors == 0) ? "PASS" : "FAIL");
+
+        // ==================================================
+        // Test 8: SHAKE256("abc", 32) from a loaded state
+        //   Padded first block loaded directly (load_final):
+        //   lane 0 = "abc" || 0x1F, byte 135 = 0x80
+        //   Output: 4 lanes (indices 4-7)
+        // ==================================================
+        $display("\n=== Test 8: SHAKE256(\"abc\", 32) via load port ===");
+        errors = 0;
+        load_state = 1600'd0;
+        load_state[63:0] = 64'h000000001F636261;
+        load_state[16*64 + 56 +: 8] = 8'h80;
+        out_len    = 13'd32;
+        load_final = 1;
+        load_valid = 1;
+        @(posedge clk);
+        #1;
+        load_valid = 0;
+        load_final = 0;
+        squeeze_and_check(8, 4, 4);
+        total_errors = total_errors + errors;
+        $display("Test 8: %s", (errors == 0) ? "PASS" : "FAIL");
+
         // ==================================================
         // Summary
         // ==================================================
@@ -0,0 +1,57 @@
+// Two-entry valid/ready skid buffer. s_ready and the m_* outputs are
+// registered, so neither the data nor the ready path is combinational
+// from one side to the other. A stall adds no bubble to the output (the
+// parked beat follows the stalled one directly), but s_ready is low from
+// the stall until the cycle after the parked beat moves to m_data, which
+// delays the next input beat by one cycle per stall.
+module skid_buffer #(
+    parameter DATA_WIDTH = 8
+) (
+    input wire clk,
+    input wire rst_n,
+
+    input wire [DATA_WIDTH-1:0] s_data,
+    input wire s_valid,
+    output reg s_ready,
+
+    output reg [DATA_WIDTH-1:0] m_data,
+    output reg m_valid,
+    input wire m_ready
+);
+
+    // Beat accepted while m_data was stalled
+    reg [DATA_WIDTH-1:0] skid_data;
+    reg skid_valid;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            m_data <= {DATA_WIDTH{1'b0}};
+            m_valid <= 1'b0;
+            skid_data <= {DATA_WIDTH{1'b0}};
+            skid_valid <= 1'b0;
+            s_ready <= 1'b0;
+        end
+        else begin
+            if (m_ready || !m_valid) begin
+                // Output register free: refill from the skid entry first
+                if (skid_valid) begin
+                    m_data <= skid_data;
+                    m_valid <= 1'b1;
+                    skid_valid <= 1'b0;
+                end
+                else begin
+                    m_data <= s_data;
+                    m_valid <= s_valid && s_ready;
+                end
+                s_ready <= 1'b1;
+            end
+            else if (s_valid && s_ready) begin
+                // Output stalled: park the beat, stop accepting
+                skid_data <= s_data;
+                skid_valid <= 1'b1;
+                s_ready <= 1'b0;
+            end
+        end
+    end
+
+endmodule